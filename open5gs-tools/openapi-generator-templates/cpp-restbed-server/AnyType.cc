@@ -12,6 +12,7 @@
  * https://drive.google.com/file/d/1cinCiA778IErENZ3JN52VFW-1ffHpx7Z/view
  */
 #include "CJson.hh"
+#include "JsonPointer.hh"
 #include "ProblemCause.hh"
 
 #include "AnyType.hh"
@@ -28,8 +29,13 @@ void AnyType::applyJSONPatch(const CJson &json)
 
     auto path_json = json.getObjectItemCaseSensitive("path");
     if (path_json.isNull()) throw ModelException(std::string("Runtime Error: JSON Patch not recognised: ") + json.serialise(),  "AnyType", "path", ProblemCause::INVALID_MSG_FORMAT);
-    std::string path(path_json.stringValue());
+    JsonPointer path(path_json.stringValue());
 
+    applyJSONPatch(json, op, path);
+}
+
+void AnyType::applyJSONPatch(const CJson &json, const std::string &op, const JsonPointer &path)
+{
     if (path.empty()) {
         if (op == "add" || op == "replace") {
             auto value_json = json.getObjectItemCaseSensitive("value");
@@ -43,6 +49,13 @@ void AnyType::applyJSONPatch(const CJson &json)
     }
 }
 
+void AnyType::applyMergePatch(const CJson &json)
+{
+    if (!m_val) m_val = new CJson(CJson::Null);
+    m_val->mergePatch(json);
+    touch();
+}
+
 } /* end namespace */
 
 /* vim:ts=8:sts=4:sw=4:expandtab:
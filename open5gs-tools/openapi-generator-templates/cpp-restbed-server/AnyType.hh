@@ -16,7 +16,10 @@
 #ifndef _OPENAPI_ANY_TYPE_HH_
 #define _OPENAPI_ANY_TYPE_HH_
 
+#include <string>
+
 #include "CJson.hh"
+#include "JsonPointer.hh"
 #include "ModelObject.hh"
 
 namespace fiveg_mag_reftools {
@@ -42,6 +45,7 @@ public:
             m_val = nullptr;
         }
         if (other.m_val) m_val = new CJson(*other.m_val);
+        touch();
         return *this;
     };
 
@@ -51,6 +55,7 @@ public:
         }
         m_val = other.m_val;
         other.m_val = nullptr;
+        touch();
         return *this;
     };
 
@@ -71,11 +76,17 @@ public:
             delete m_val;
         }
         m_val = new CJson(json);
+        touch();
     };
 
     virtual bool validate() const { return true; };
 
+    /* Any JSON value is accepted */
+    static bool jsonSignatureMatches([[maybe_unused]] const CJson &json, [[maybe_unused]] bool as_request = true) { return true; };
+
     void applyJSONPatch(const CJson &json);
+    void applyJSONPatch(const CJson &json, const std::string &op, const JsonPointer &path);
+    void applyMergePatch(const CJson &json);
 
 private:
     CJson *m_val;
@@ -0,0 +1,56 @@
+/**************************************************************************
+ * Base64.cc : Base64 codec for ByteArray properties
+ **************************************************************************
+ * Wraps the codec in OpenAPI_base64_kernel.h, which is shared with the C
+ * bindings, with std::string results.
+ **************************************************************************
+ * License: 5G-MAG Public License (v1.0)
+ * Author: David Waring
+ * Copyright: (C)2025 British Broadcasting Corporation
+ *
+ * For full license terms please see the LICENSE file distributed with this
+ * program. If this file is missing then the license can be retrieved from
+ * https://drive.google.com/file/d/1cinCiA778IErENZ3JN52VFW-1ffHpx7Z/view
+ */
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "OpenAPI_base64_kernel.h"
+
+#include "Base64.hh"
+
+namespace fiveg_mag_reftools {
+
+std::string Base64::encode(const unsigned char *data, std::size_t len)
+{
+    std::string ret(OPENAPI_BASE64_ENCODED_SIZE(len), '\0');
+
+    _base64_encode(data, len, ret.data());
+
+    return ret;
+}
+
+bool Base64::decode(std::string_view str, std::basic_string<unsigned char> &out)
+{
+    std::basic_string<unsigned char> ret(OPENAPI_BASE64_DECODE_BUFFER_SIZE(str.size()), 0);
+    std::size_t len;
+
+    if (!_base64_decode(str.data(), str.size(), ret.data(), &len)) return false;
+
+    ret.resize(len);
+    out = std::move(ret);
+    return true;
+}
+
+bool Base64::isValid(std::string_view str)
+{
+    return _base64_is_valid(str.data(), str.size());
+}
+
+} /* end namespace */
+
+/* vim:ts=8:sts=4:sw=4:expandtab:
+ */
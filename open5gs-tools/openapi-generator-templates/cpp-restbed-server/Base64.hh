@@ -0,0 +1,50 @@
+/**************************************************************************
+ * Base64.hh : Base64 codec for ByteArray properties
+ **************************************************************************
+ * ByteArray ("format: byte") properties hold the decoded bytes, the
+ * conversions to and from CJson use this class to decode and encode the
+ * standard (RFC 4648 section 4) base64 text carried in the JSON.
+ *
+ * Encoding always pads with '='. Decoding and validation accept the value
+ * with or without its trailing padding but reject any other character,
+ * including whitespace. Where the CPU supports it the bulk of the data is
+ * handled with SSSE3 or AVX2, selected at run time.
+ **************************************************************************
+ * License: 5G-MAG Public License (v1.0)
+ * Author: David Waring
+ * Copyright: (C)2025 British Broadcasting Corporation
+ *
+ * For full license terms please see the LICENSE file distributed with this
+ * program. If this file is missing then the license can be retrieved from
+ * https://drive.google.com/file/d/1cinCiA778IErENZ3JN52VFW-1ffHpx7Z/view
+ */
+
+#ifndef _OPENAPI_BASE64_HH_
+#define _OPENAPI_BASE64_HH_
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace fiveg_mag_reftools {
+
+class Base64 {
+public:
+    static std::string encode(const unsigned char *data, std::size_t len);
+    static std::string encode(std::basic_string_view<unsigned char> data) { return encode(data.data(), data.size()); };
+
+    /* Returns false, leaving out unchanged, if str is not valid base64 */
+    static bool decode(std::string_view str, std::basic_string<unsigned char> &out);
+
+    static bool isValid(std::string_view str);
+
+private:
+    Base64() = delete;
+};
+
+} /* end namespace */
+
+/* vim:ts=8:sts=4:sw=4:expandtab:
+ */
+
+#endif /* _OPENAPI_BASE64_HH_ */
@@ -0,0 +1,109 @@
+/**************************************************************************
+ * BatchDecoder.cc : Decoding of streams of homogeneous model records
+ **************************************************************************
+ * License: 5G-MAG Public License (v1.0)
+ * Author: David Waring
+ * Copyright: (C)2025 British Broadcasting Corporation
+ *
+ * For full license terms please see the LICENSE file distributed with this
+ * program. If this file is missing then the license can be retrieved from
+ * https://drive.google.com/file/d/1cinCiA778IErENZ3JN52VFW-1ffHpx7Z/view
+ */
+
+#include <cstddef>
+#include <sstream>
+#include <string>
+#include <string_view>
+
+#include "sbi/openapi/external/cJSON.h"
+
+#include "CJson.hh"
+#include "ModelException.hh"
+#include "ProblemCause.hh"
+
+#include "BatchDecoder.hh"
+
+namespace fiveg_mag_reftools {
+
+static std::string_view skip_whitespace(std::string_view str)
+{
+    std::size_t pos = str.find_first_not_of(" \t\r\n");
+    return (pos == std::string_view::npos)?std::string_view():str.substr(pos);
+}
+
+BatchDecoder::BatchDecoder(std::string_view input, Format format)
+    :m_input(skip_whitespace(input))
+    ,m_format(format)
+    ,m_document(nullptr, false)
+    ,m_cursor(nullptr)
+    ,m_count(0)
+{
+    if (m_format == Format::AUTO) {
+        m_format = (!m_input.empty() && m_input.front() == '[')?Format::ARRAY:Format::NDJSON;
+    }
+
+    if (m_format == Format::ARRAY) {
+        const char *end = nullptr;
+        cJSON *json = cJSON_ParseWithLengthOpts(m_input.data(), m_input.size(), &end, false);
+        if (json && !skip_whitespace(m_input.substr(end - m_input.data())).empty()) {
+            cJSON_Delete(json);
+            json = nullptr;
+        }
+        if (!json) {
+            throw ModelException("Unable to parse JSON", "CJson", std::string(), ProblemCause::INVALID_MSG_FORMAT);
+        }
+        m_document = CJson(json);
+        if (!m_document.isArray()) {
+            throw ModelException("Batch of records is not a JSON array", "CJson", std::string(), ProblemCause::INVALID_MSG_FORMAT);
+        }
+        m_cursor = json->child;
+        m_input = std::string_view();
+    }
+}
+
+bool BatchDecoder::next(CJson &record)
+{
+    if (m_format == Format::ARRAY) {
+        if (!m_cursor) return false;
+        record = CJson(m_cursor, false);
+        m_cursor = m_cursor->next;
+    } else {
+        if (m_input.empty()) return false;
+        const char *end = nullptr;
+        cJSON *json = cJSON_ParseWithLengthOpts(m_input.data(), m_input.size(), &end, false);
+        if (!json) {
+            std::ostringstream param;
+            param << "[" << m_count << "]";
+            throw ModelException("Unable to parse JSON", "CJson", param.str(), ProblemCause::INVALID_MSG_FORMAT);
+        }
+        record = CJson(json);
+
+        /* Each record ends its line, blank lines between records are
+         * skipped */
+        std::string_view rest(m_input.substr(end - m_input.data()));
+        std::size_t pos = rest.find_first_not_of(" \t\r");
+        if (pos != std::string_view::npos && rest[pos] != '\n') {
+            std::ostringstream param;
+            param << "[" << m_count << "]";
+            throw ModelException("NDJSON record is not followed by a newline", "CJson", param.str(), ProblemCause::INVALID_MSG_FORMAT);
+        }
+        m_input = skip_whitespace(rest);
+    }
+    m_count++;
+    return true;
+}
+
+ModelException BatchDecoder::recordException(const ModelException &ex, std::size_t idx)
+{
+    std::ostringstream param;
+    param << "[" << idx << "]";
+    if (ex.parameter.size() > 0) {
+        param << "." << ex.parameter;
+    }
+    return ModelException(ex.what(), ex.classname, param.str(), ex.cause);
+}
+
+} /* end namespace */
+
+/* vim:ts=8:sts=4:sw=4:expandtab:
+ */
@@ -0,0 +1,135 @@
+/**************************************************************************
+ * BatchDecoder.hh : Decoding of streams of homogeneous model records
+ **************************************************************************
+ * Decodes a batch of records given either as a top-level JSON array or as
+ * newline-delimited JSON (NDJSON), where each record must be followed by a
+ * newline ("\n" or "\r\n") or the end of the input. The input is scanned
+ * in place by a single decoder, NDJSON records are parsed one after another
+ * from the same buffer without being split into separate strings, and each
+ * record's parse tree is released as soon as the record has been decoded.
+ * Per-class validator state (e.g. compiled patterns) is shared between
+ * all the records decoded.
+ *
+ * Records are delivered to a sink, which is either a callable taking the
+ * decoded model (by value, reference or std::shared_ptr) or an output
+ * iterator. A callable which returns bool can return false to stop the
+ * batch early.
+ *
+ *   std::list<Foo> foos;
+ *   Foo::decodeBatch(body, std::back_inserter(foos));
+ *
+ * If a record fails to parse or decode a ModelException is thrown with the
+ * record index prefixed to the parameter, e.g. "[3].label". Records before
+ * the failing one will already have been delivered.
+ **************************************************************************
+ * License: 5G-MAG Public License (v1.0)
+ * Author: David Waring
+ * Copyright: (C)2025 British Broadcasting Corporation
+ *
+ * For full license terms please see the LICENSE file distributed with this
+ * program. If this file is missing then the license can be retrieved from
+ * https://drive.google.com/file/d/1cinCiA778IErENZ3JN52VFW-1ffHpx7Z/view
+ */
+
+#ifndef _OPENAPI_BATCH_DECODER_HH_
+#define _OPENAPI_BATCH_DECODER_HH_
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+#include "CJson.hh"
+#include "ModelException.hh"
+
+namespace fiveg_mag_reftools {
+
+class BatchDecoder {
+public:
+    enum class Format {
+        AUTO,           /* JSON array if the input starts with '[', NDJSON otherwise */
+        ARRAY,
+        NDJSON
+    };
+
+    explicit BatchDecoder(std::string_view input, Format format = Format::AUTO);
+    BatchDecoder(const BatchDecoder&) = delete;
+    BatchDecoder &operator=(const BatchDecoder&) = delete;
+    virtual ~BatchDecoder() {};
+
+    /* Parse the next record into record, returns false once the input is
+     * exhausted. record is only valid until the next call. Throws
+     * ModelException if the input cannot be parsed. */
+    bool next(CJson &record);
+
+    /* Index of the last record returned by next() */
+    std::size_t index() const { return m_count - 1; };
+
+    /* Decode all records of type T from input into sink, returns the number
+     * of records delivered */
+    template <class T, class Sink>
+    static std::size_t decode(std::string_view input, Sink &&sink, bool as_request = true, Format format = Format::AUTO);
+
+private:
+    static ModelException recordException(const ModelException &ex, std::size_t idx);
+
+    std::string_view m_input;   /* NDJSON input remaining */
+    Format m_format;
+    CJson m_document;           /* parsed ARRAY input */
+    cJSON *m_cursor;            /* next ARRAY element */
+    std::size_t m_count;
+};
+
+template <class T, class Sink>
+std::size_t BatchDecoder::decode(std::string_view input, Sink &&sink, bool as_request, Format format)
+{
+    BatchDecoder decoder(input, format);
+    CJson record(nullptr, false);
+
+    while (decoder.next(record)) {
+        std::size_t idx = decoder.index();
+        try {
+            if constexpr (std::is_invocable_v<Sink, T&&>) {
+                if constexpr (std::is_convertible_v<std::invoke_result_t<Sink, T&&>, bool>) {
+                    if (!std::invoke(sink, T(record, as_request))) return idx + 1;
+                } else {
+                    std::invoke(sink, T(record, as_request));
+                }
+            } else if constexpr (std::is_invocable_v<Sink, T&>) {
+                /* a sink taking a non-const reference can't bind a temporary */
+                T value(record, as_request);
+                if constexpr (std::is_convertible_v<std::invoke_result_t<Sink, T&>, bool>) {
+                    if (!std::invoke(sink, value)) return idx + 1;
+                } else {
+                    std::invoke(sink, value);
+                }
+            } else if constexpr (std::is_invocable_v<Sink, std::shared_ptr<T> >) {
+                if constexpr (std::is_convertible_v<std::invoke_result_t<Sink, std::shared_ptr<T> >, bool>) {
+                    if (!std::invoke(sink, std::make_shared<T>(record, as_request))) return idx + 1;
+                } else {
+                    std::invoke(sink, std::make_shared<T>(record, as_request));
+                }
+            } else if constexpr (std::is_assignable_v<decltype(*sink), T&&>) {
+                *sink = T(record, as_request);
+                ++sink;
+            } else {
+                *sink = std::make_shared<T>(record, as_request);
+                ++sink;
+            }
+        } catch (ModelException &ex) {
+            throw recordException(ex, idx);
+        }
+    }
+
+    return decoder.m_count;
+}
+
+} /* end namespace */
+
+/* vim:ts=8:sts=4:sw=4:expandtab:
+ */
+
+#endif /* _OPENAPI_BATCH_DECODER_HH_ */
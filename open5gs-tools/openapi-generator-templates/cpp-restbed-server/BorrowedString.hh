@@ -0,0 +1,181 @@
+/**************************************************************************
+ * BorrowedString.hh : String values borrowed from a retained JSON document
+ **************************************************************************
+ * A BorrowedString is a view of a string value which keeps the storage it
+ * views alive. When decoded from a CJson node belonging to a retained
+ * document (see CJson::parseRetained()) the view points directly at the
+ * string in the parsed document and shares ownership of the document, so
+ * no copy is made. Otherwise, or after detach(), it views its own copy.
+ *
+ * Model string and ByteArray properties are generated using these types
+ * when the "borrowedStrings" generator option is set. Models then provide
+ * detach() to convert all their borrowed values to owned values, which
+ * releases the retained document once no other references remain.
+ * ByteArray values (BorrowedBytes) are decoded from base64, so are always
+ * owned copies.
+ **************************************************************************
+ * License: 5G-MAG Public License (v1.0)
+ * Author: David Waring
+ * Copyright: (C)2025 British Broadcasting Corporation
+ *
+ * For full license terms please see the LICENSE file distributed with this
+ * program. If this file is missing then the license can be retrieved from
+ * https://drive.google.com/file/d/1cinCiA778IErENZ3JN52VFW-1ffHpx7Z/view
+ */
+
+#ifndef _OPENAPI_BORROWED_STRING_HH_
+#define _OPENAPI_BORROWED_STRING_HH_
+
+#include <cstring>
+#include <list>
+#include <map>
+#include <memory>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#include "Base64.hh"
+#include "CJson.hh"
+#include "ModelException.hh"
+#include "ModelObject.hh"
+#include "ProblemCause.hh"
+
+namespace fiveg_mag_reftools {
+
+template <class CharT>
+class BasicBorrowedString {
+public:
+    typedef CharT value_type;
+    typedef std::basic_string_view<CharT> view_type;
+    typedef std::basic_string<CharT> string_type;
+    typedef typename view_type::size_type size_type;
+
+    BasicBorrowedString() :m_view() ,m_storage() ,m_borrowed(false) {};
+    BasicBorrowedString(const string_type &value) :m_view() ,m_storage() ,m_borrowed(false) { own(view_type(value)); };
+    BasicBorrowedString(view_type value) :m_view() ,m_storage() ,m_borrowed(false) { own(value); };
+    BasicBorrowedString(const CharT *value) :m_view() ,m_storage() ,m_borrowed(false) { if (value) own(view_type(value)); };
+    explicit BasicBorrowedString(const CJson &json)
+        :m_view()
+        ,m_storage()
+        ,m_borrowed(false)
+    {
+        const char *value = json.stringValue();
+        if (!value) throw ModelException("Attempt to access non-string value as string", "CJson", std::string(), ProblemCause::INVALID_MSG_FORMAT);
+        if constexpr (std::is_same_v<CharT, unsigned char>) {
+            /* ByteArray values are base64 in the document so cannot be borrowed */
+            string_type decoded;
+            if (!Base64::decode(value, decoded)) throw ModelException("String value is not base64 encoded", "CJson", std::string(), ProblemCause::INVALID_MSG_FORMAT);
+            own(view_type(decoded));
+            return;
+        }
+        view_type view(reinterpret_cast<const CharT*>(value), std::strlen(value));
+        if (json.document()) {
+            m_view = view;
+            m_storage = json.document();
+            m_borrowed = true;
+        } else {
+            own(view);
+        }
+    };
+    BasicBorrowedString(const BasicBorrowedString &other) = default;
+    BasicBorrowedString(BasicBorrowedString &&other) = default;
+
+    BasicBorrowedString &operator=(const BasicBorrowedString &other) = default;
+    BasicBorrowedString &operator=(BasicBorrowedString &&other) = default;
+
+    /* true if this value still refers to a retained document */
+    bool isBorrowed() const { return m_borrowed; };
+
+    /* Take a private copy of a borrowed value */
+    void detach() { if (m_borrowed) own(m_view); };
+
+    view_type view() const { return m_view; };
+    string_type str() const { return string_type(m_view); };
+    const CharT *data() const { return m_view.data(); };
+    size_type size() const { return m_view.size(); };
+    bool empty() const { return m_view.empty(); };
+
+    operator view_type() const { return m_view; };
+
+    bool operator==(const BasicBorrowedString &other) const { return m_view == other.m_view; };
+    bool operator!=(const BasicBorrowedString &other) const { return m_view != other.m_view; };
+    bool operator==(view_type other) const { return m_view == other; };
+    bool operator!=(view_type other) const { return m_view != other; };
+    bool operator==(const CharT *other) const { return m_view == view_type(other); };
+    bool operator!=(const CharT *other) const { return m_view != view_type(other); };
+    bool operator<(const BasicBorrowedString &other) const { return m_view < other.m_view; };
+
+private:
+    void own(view_type value) {
+        std::shared_ptr<const string_type> copy(std::make_shared<const string_type>(value));
+        m_view = view_type(*copy);
+        m_storage = std::move(copy);
+        m_borrowed = false;
+    };
+
+    view_type m_view;
+    std::shared_ptr<const void> m_storage;
+    bool m_borrowed;
+};
+
+typedef BasicBorrowedString<char> BorrowedString;
+typedef BasicBorrowedString<unsigned char> BorrowedBytes;
+
+inline std::ostream &operator<<(std::ostream &os, const BorrowedString &str) { return os << str.view(); }
+
+/* Generic detach() over model property values */
+template <class T> void detachValue(T &value);
+template <class C> void detachValue(BasicBorrowedString<C> &value);
+template <class T> void detachValue(std::optional<T> &value);
+template <class T> void detachValue(std::shared_ptr<T> &value);
+template <class T, class A> void detachValue(std::list<T, A> &value);
+template <class K, class T, class C, class A> void detachValue(std::map<K, T, C, A> &value);
+
+template <class T>
+void detachValue(T &value)
+{
+    if constexpr (std::is_base_of_v<ModelObject, T>) value.detach();
+}
+
+template <class C>
+void detachValue(BasicBorrowedString<C> &value)
+{
+    value.detach();
+}
+
+template <class T>
+void detachValue(std::optional<T> &value)
+{
+    if (value.has_value()) detachValue(value.value());
+}
+
+/* Children may be shared with other copies of the parent (see
+ * copyOnWrite()), which must keep their own values */
+template <class T>
+void detachValue(std::shared_ptr<T> &value)
+{
+    if (!value) return;
+    copyOnWrite(value);
+    detachValue(*value);
+}
+
+template <class T, class A>
+void detachValue(std::list<T, A> &value)
+{
+    for (auto &item : value) detachValue(item);
+}
+
+template <class K, class T, class C, class A>
+void detachValue(std::map<K, T, C, A> &value)
+{
+    for (auto &item : value) detachValue(item.second);
+}
+
+} /* end namespace */
+
+/* vim:ts=8:sts=4:sw=4:expandtab:
+ */
+
+#endif /* _OPENAPI_BORROWED_STRING_HH_ */
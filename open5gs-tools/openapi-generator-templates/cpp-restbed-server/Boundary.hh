@@ -16,6 +16,11 @@
 #ifndef _OPENAPI_BOUNDARY_HH_
 #define _OPENAPI_BOUNDARY_HH_
 
+#include <cstddef>
+#include <list>
+
+#include "OgsAllocator.hh"
+
 namespace fiveg_mag_reftools {
 
 template <class T>
@@ -13,11 +13,20 @@
  */
 
 #include <cmath>
+#include <cstdlib>
+#include <functional>
 #include <iterator>
+#include <string>
+#include <string_view>
 
+#include "Base64.hh"
 #include "ModelException.hh"
+#include "ModelHash.hh"
 #include "ModelObject.hh"
 #include "CJson.hh"
+#include "DateTime.hh"
+#include "InternedString.hh"
+#include "BorrowedString.hh"
 
 namespace fiveg_mag_reftools {
 
@@ -33,6 +42,463 @@ CJson CJson::wrap(const ModelObject *ptr, bool as_request)
     return ptr->toJSON(as_request);
 }
 
+CJson CJson::wrap(const InternedString &val, [[maybe_unused]] bool as_request)
+{
+    return CJson(cJSON_CreateString(val.c_str()));
+}
+
+CJson CJson::wrap(const DateTime &val, [[maybe_unused]] bool as_request)
+{
+    return CJson(cJSON_CreateString(val.str().c_str()));
+}
+
+CJson CJson::wrap(const Date &val, [[maybe_unused]] bool as_request)
+{
+    return CJson(cJSON_CreateString(val.str().c_str()));
+}
+
+CJson CJson::wrap(const BasicBorrowedString<char> &val, [[maybe_unused]] bool as_request)
+{
+    return CJson(cJSON_CreateString(val.str().c_str()));
+}
+
+CJson CJson::wrap(const BasicBorrowedString<unsigned char> &val, [[maybe_unused]] bool as_request)
+{
+    return CJson(cJSON_CreateString(Base64::encode(val.view()).c_str()));
+}
+
+CJson CJson::wrap(const std::basic_string<unsigned char> &val, [[maybe_unused]] bool as_request)
+{
+    return CJson(cJSON_CreateString(Base64::encode(val).c_str()));
+}
+
+CJson::operator std::basic_string<unsigned char>() const
+{
+    std::basic_string<unsigned char> ret;
+
+    if (!isString()) throw ModelException("Attempt to access non-string value as string", "CJson", std::string(), ProblemCause::INVALID_MSG_FORMAT);
+    if (!Base64::decode(stringValue(), ret)) throw ModelException("String value is not base64 encoded", "CJson", std::string(), ProblemCause::INVALID_MSG_FORMAT);
+
+    return ret;
+}
+
+/* RFC 7396 MergePatch(target, patch), target is consumed and the result returned */
+static cJSON *merge_patch(cJSON *target, const cJSON *patch)
+{
+    if (!cJSON_IsObject(patch)) {
+        cJSON_Delete(target);
+        return cJSON_Duplicate(patch, 1);
+    }
+
+    if (!cJSON_IsObject(target)) {
+        cJSON_Delete(target);
+        target = cJSON_CreateObject();
+    }
+
+    for (const cJSON *item = patch->child; item; item = item->next) {
+        if (cJSON_IsNull(item)) {
+            cJSON_DeleteItemFromObjectCaseSensitive(target, item->string);
+            continue;
+        }
+        cJSON *existing = cJSON_GetObjectItemCaseSensitive(target, item->string);
+        if (cJSON_IsObject(existing) && cJSON_IsObject(item)) {
+            /* merges in place, so existing stays in target */
+            merge_patch(existing, item);
+        } else if (existing) {
+            cJSON_ReplaceItemInObjectCaseSensitive(target, item->string, merge_patch(nullptr, item));
+        } else {
+            cJSON_AddItemToObject(target, item->string, merge_patch(nullptr, item));
+        }
+    }
+
+    return target;
+}
+
+static std::size_t hash_node(const cJSON *node)
+{
+    if (!node || cJSON_IsNull(node)) return 0;
+    if (cJSON_IsBool(node)) return cJSON_IsTrue(node)?1:2;
+    /* cJSON_Compare() treats numbers within a relative epsilon of each other
+     * as equal, which no hash of the value can agree with at every boundary,
+     * so all numbers hash the same and only the other values tell them apart */
+    if (cJSON_IsNumber(node)) return 3;
+    if (cJSON_IsString(node)) return std::hash<std::string_view>()(cJSON_GetStringValue(node));
+
+    std::size_t seed = cJSON_GetArraySize(node);
+    if (cJSON_IsArray(node)) {
+        for (const cJSON *item = node->child; item; item = item->next) {
+            hashCombine(seed, hash_node(item));
+        }
+    } else if (cJSON_IsObject(node)) {
+        /* cJSON_Compare() ignores member order, so combine members with + */
+        std::size_t members = 0;
+        for (const cJSON *item = node->child; item; item = item->next) {
+            std::size_t member = std::hash<std::string_view>()(item->string);
+            hashCombine(member, hash_node(item));
+            members += member;
+        }
+        hashCombine(seed, members);
+    }
+    return seed;
+}
+
+std::size_t CJson::hash() const
+{
+    return hash_node(m_node);
+}
+
+void CJson::mergePatch(const CJson &patch)
+{
+    if (isObject() && patch.isObject()) {
+        merge_patch(m_node, patch.m_node);
+    } else {
+        *this = CJson(merge_patch(nullptr, patch.m_node));
+    }
+}
+
+
+/* Same limit as cJSON_Parse() */
+static const std::size_t push_parser_nesting_limit = 1000;
+
+/* cJSON_Parse() skips any control character or space between tokens */
+static bool is_json_whitespace(char c)
+{
+    return static_cast<unsigned char>(c) <= ' ';
+}
+
+static int hex_value(char c)
+{
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+/* Read 4 hex digits at str[pos], returns -1 if str ends first. As in
+ * cJSON_Parse(), an invalid digit makes the value 0. */
+static long parse_hex4(const std::string &str, std::size_t pos)
+{
+    if (pos + 4 > str.size()) return -1;
+    long ret = 0;
+    for (std::size_t i = pos; i < pos + 4; i++) {
+        int digit = hex_value(str[i]);
+        if (digit < 0) return 0;
+        ret = (ret << 4) | digit;
+    }
+    return ret;
+}
+
+static void append_utf8(std::string &out, unsigned long code)
+{
+    if (code < 0x80) {
+        out += static_cast<char>(code);
+    } else if (code < 0x800) {
+        out += static_cast<char>(0xc0 | (code >> 6));
+        out += static_cast<char>(0x80 | (code & 0x3f));
+    } else if (code < 0x10000) {
+        out += static_cast<char>(0xe0 | (code >> 12));
+        out += static_cast<char>(0x80 | ((code >> 6) & 0x3f));
+        out += static_cast<char>(0x80 | (code & 0x3f));
+    } else {
+        out += static_cast<char>(0xf0 | (code >> 18));
+        out += static_cast<char>(0x80 | ((code >> 12) & 0x3f));
+        out += static_cast<char>(0x80 | ((code >> 6) & 0x3f));
+        out += static_cast<char>(0x80 | (code & 0x3f));
+    }
+}
+
+/* Undo the escapes in the body of a JSON string, returns false if an escape
+ * is not valid */
+static bool unescape_string(const std::string &in, std::string &out)
+{
+    out.clear();
+    out.reserve(in.size());
+    for (std::size_t i = 0; i < in.size(); i++) {
+        if (in[i] != '\\') {
+            out += in[i];
+            continue;
+        }
+        if (++i >= in.size()) return false;
+        switch (in[i]) {
+        case '"': out += '"'; break;
+        case '\\': out += '\\'; break;
+        case '/': out += '/'; break;
+        case 'b': out += '\b'; break;
+        case 'f': out += '\f'; break;
+        case 'n': out += '\n'; break;
+        case 'r': out += '\r'; break;
+        case 't': out += '\t'; break;
+        case 'u': {
+                long code = parse_hex4(in, i + 1);
+                if (code < 0 || (code >= 0xdc00 && code <= 0xdfff)) return false;
+                i += 4;
+                if (code >= 0xd800 && code <= 0xdbff) {
+                    /* UTF-16 surrogate pair */
+                    if (i + 2 >= in.size() || in[i + 1] != '\\' || in[i + 2] != 'u') return false;
+                    long low = parse_hex4(in, i + 3);
+                    if (low < 0xdc00 || low > 0xdfff) return false;
+                    i += 6;
+                    code = 0x10000 + (((code & 0x3ff) << 10) | (low & 0x3ff));
+                }
+                append_utf8(out, code);
+            }
+            break;
+        default:
+            return false;
+        }
+    }
+    return true;
+}
+
+/* Read a number as cJSON_Parse() does, as much of str as strtod() accepts,
+ * so "01" and "1." are numbers. Returns the number of characters used, 0
+ * if str does not start with a number. */
+static std::size_t parse_number(const std::string &str, double &value)
+{
+    char *end = nullptr;
+    value = std::strtod(str.c_str(), &end);
+    return end - str.c_str();
+}
+
+CJson::PushParser::PushParser()
+    :m_state(State::START)
+    ,m_root(nullptr)
+    ,m_stack()
+    ,m_token()
+    ,m_key()
+    ,m_isKey(false)
+    ,m_escape(false)
+{
+}
+
+CJson::PushParser::~PushParser()
+{
+    if (m_root) cJSON_Delete(m_root);
+}
+
+void CJson::PushParser::reset()
+{
+    if (m_root) cJSON_Delete(m_root);
+    m_root = nullptr;
+    m_stack.clear();
+    m_token.clear();
+    m_key.clear();
+    m_isKey = false;
+    m_escape = false;
+    m_state = State::START;
+}
+
+bool CJson::PushParser::complete() const
+{
+    double value;
+    return m_state == State::DONE || (m_state == State::NUMBER && m_stack.empty() && parse_number(m_token, value) > 0);
+}
+
+CJson CJson::PushParser::finish()
+{
+    /* a number at the top level is only ended by the end of input */
+    if (m_state == State::NUMBER && m_stack.empty()) endNumber();
+    if (m_state != State::DONE) fail();
+
+    CJson ret(m_root);
+    m_root = nullptr;
+    reset();
+    return ret;
+}
+
+void CJson::PushParser::feed(const char *data, std::size_t length)
+{
+    if (m_state == State::FAILED) fail();
+
+    for (std::size_t i = 0; i < length; i++) {
+        char c = data[i];
+        if (c == '\0' && m_state != State::DONE) {
+            /* cJSON_Parse() takes a NUL as the end of the input */
+            if (m_state == State::NUMBER && m_stack.empty()) endNumber();
+            if (m_state != State::DONE) fail();
+        }
+        switch (m_state) {
+        case State::START:
+            /* cJSON_Parse() skips a UTF-8 byte order mark at the very start */
+            if (c == "\xEF\xBB\xBF"[m_token.size()]) {
+                m_token += c;
+                if (m_token.size() == 3) {
+                    m_token.clear();
+                    m_state = State::VALUE;
+                }
+            } else if (!m_token.empty()) {
+                fail();
+            } else {
+                m_state = State::VALUE;
+                i--;
+            }
+            break;
+        case State::DONE:
+            /* cJSON_Parse() ignores anything after the document */
+            return;
+        case State::STRING:
+            if (m_escape) {
+                m_token += c;
+                m_escape = false;
+            } else if (c == '\\') {
+                m_token += c;
+                m_escape = true;
+            } else if (c == '"') {
+                endString();
+            } else {
+                /* copy the run of plain characters in one go, cJSON_Parse()
+                 * also allows control characters in strings */
+                std::size_t end = i + 1;
+                while (end < length && data[end] != '"' && data[end] != '\\' && data[end] != '\0') end++;
+                m_token.append(data + i, end - i);
+                i = end - 1;
+            }
+            break;
+        case State::NUMBER:
+            if ((c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E') {
+                m_token += c;
+            } else {
+                endNumber();
+                i--;    /* c follows the number */
+            }
+            break;
+        case State::LITERAL:
+            /* ends as soon as it spells true, false or null */
+            m_token += c;
+            if (m_token.size() >= 4) endLiteral();
+            break;
+        default:
+            if (is_json_whitespace(c)) break;
+            switch (m_state) {
+            case State::VALUE:
+                startValue(c);
+                break;
+            case State::VALUE_OR_END:
+                if (c == ']') {
+                    endContainer(c);
+                } else {
+                    startValue(c);
+                }
+                break;
+            case State::KEY:
+            case State::KEY_OR_END:
+                if (c == '"') {
+                    m_token.clear();
+                    m_isKey = true;
+                    m_state = State::STRING;
+                } else if (c == '}' && m_state == State::KEY_OR_END) {
+                    endContainer(c);
+                } else {
+                    fail();
+                }
+                break;
+            case State::COLON:
+                if (c != ':') fail();
+                m_state = State::VALUE;
+                break;
+            case State::COMMA_OR_END:
+                if (c == ',') {
+                    m_state = cJSON_IsArray(m_stack.back())?State::VALUE:State::KEY;
+                } else {
+                    endContainer(c);
+                }
+                break;
+            default:
+                break;
+            }
+        }
+    }
+}
+
+void CJson::PushParser::fail()
+{
+    m_state = State::FAILED;
+    throw ModelException("Unable to parse JSON", "CJson", std::string(), ProblemCause::INVALID_MSG_FORMAT);
+}
+
+void CJson::PushParser::startValue(char c)
+{
+    m_token.clear();
+    if (c == '{') {
+        addValue(cJSON_CreateObject());
+    } else if (c == '[') {
+        addValue(cJSON_CreateArray());
+    } else if (c == '"') {
+        m_isKey = false;
+        m_state = State::STRING;
+    } else if (c == '-' || (c >= '0' && c <= '9')) {
+        m_token += c;
+        m_state = State::NUMBER;
+    } else if (c == 't' || c == 'f' || c == 'n') {
+        m_token += c;
+        m_state = State::LITERAL;
+    } else {
+        fail();
+    }
+}
+
+void CJson::PushParser::addValue(cJSON *item)
+{
+    if (m_stack.empty()) {
+        m_root = item;
+    } else if (cJSON_IsArray(m_stack.back())) {
+        cJSON_AddItemToArray(m_stack.back(), item);
+    } else {
+        cJSON_AddItemToObject(m_stack.back(), m_key.c_str(), item);
+    }
+
+    if (cJSON_IsArray(item) || cJSON_IsObject(item)) {
+        if (m_stack.size() >= push_parser_nesting_limit) fail();
+        m_stack.push_back(item);
+        m_state = cJSON_IsArray(item)?State::VALUE_OR_END:State::KEY_OR_END;
+    } else {
+        m_state = m_stack.empty()?State::DONE:State::COMMA_OR_END;
+    }
+}
+
+void CJson::PushParser::endContainer(char c)
+{
+    if (c != (cJSON_IsArray(m_stack.back())?']':'}')) fail();
+    m_stack.pop_back();
+    m_state = m_stack.empty()?State::DONE:State::COMMA_OR_END;
+}
+
+void CJson::PushParser::endString()
+{
+    std::string value;
+    if (!unescape_string(m_token, value)) fail();
+    if (m_isKey) {
+        m_key = std::move(value);
+        m_state = State::COLON;
+    } else {
+        addValue(cJSON_CreateString(value.c_str()));
+    }
+}
+
+void CJson::PushParser::endNumber()
+{
+    double value;
+    std::size_t used = parse_number(m_token, value);
+
+    /* any number characters strtod() did not use are trailing data at the
+     * top level, but are not valid inside an array or object */
+    if (used == 0 || (used < m_token.size() && !m_stack.empty())) fail();
+    addValue(cJSON_CreateNumber(value));
+}
+
+void CJson::PushParser::endLiteral()
+{
+    if (m_token == "true") {
+        addValue(cJSON_CreateTrue());
+    } else if (m_token == "null") {
+        addValue(cJSON_CreateNull());
+    } else if (m_token == "false") {
+        addValue(cJSON_CreateFalse());
+    } else if (m_token.size() > 4 || m_token != "fals") {
+        fail();
+    }
+}
+
 } /* end namespace */
 
 /* vim:ts=8:sts=4:sw=4:expandtab:
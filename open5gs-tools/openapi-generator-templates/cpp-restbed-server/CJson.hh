@@ -18,6 +18,9 @@
 #include <cmath>
 #include <iterator>
 #include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
 
 #include "sbi/openapi/external/cJSON.h"
 #include "ModelException.hh"
@@ -25,6 +28,10 @@
 namespace fiveg_mag_reftools {
 
 class ModelObject;
+class DateTime;
+class Date;
+class InternedString;
+template <class CharT> class BasicBorrowedString;
 
 class CJson {
 public:
@@ -39,38 +46,46 @@ public:
         typedef T &reference;
         typedef std::forward_iterator_tag iterator_type;
 
-        Iterator(T *node, std::size_t index = 0) : m_node(node), m_index(index) {};
+        Iterator(T *node, std::size_t index = 0) : m_node(node), m_index(index), m_child(node->firstChild()) {
+            for (std::size_t i = 0; i < index && m_child; i++) m_child = m_child->next;
+            if (!m_child) m_index = m_node->arraySize();
+        };
 
-        bool operator==(const Iterator<T> &other) const { return other.m_node == m_node && other.m_index == m_index; };
-        bool operator!=(const Iterator<T> &other) const { return other.m_node != m_node || other.m_index != m_index; };
+        bool operator==(const Iterator<T> &other) const { return other.m_node == m_node && other.m_child == m_child; };
+        bool operator!=(const Iterator<T> &other) const { return other.m_node != m_node || other.m_child != m_child; };
         bool operator<(const Iterator<T> &other) const { return other.m_node == m_node && m_index < other.m_index; };
         bool operator>(const Iterator<T> &other) const { return other.m_node == m_node && m_index > other.m_index; };
 
         value_type operator*() const
         {
-            return m_node->index(m_index);
+            return m_child?CJson(m_child, m_node->m_document):Null;
         };
 
+        /* Follows the sibling link, so iterating over all elements is O(n) */
         Iterator<T> &operator++() {
-            if (m_index < m_node->arraySize()) m_index++;
+            if (m_child) {
+                m_child = m_child->next;
+                m_index++;
+            }
             return *this;
         };
 
         Iterator<T> operator+(std::size_t n) {
-            std::size_t new_index = m_index + n;
-            if (new_index > m_node->arraySize()) new_index = m_node->arraySize();
-            return Iterator<T>(m_node, new_index);
+            Iterator<T> ret(*this);
+            for (; n > 0 && ret.m_child; n--) ++ret;
+            return ret;
         };
     private:
         T *m_node;
         std::size_t m_index;
+        cJSON *m_child;
     };
     typedef Iterator<CJson> iterator;
     typedef Iterator<const CJson> const_iterator;
 
-    CJson(cJSON *c_json, bool owner = true) : m_owner(owner), m_node(c_json) {};
-    CJson(const CJson &other) : m_owner(true), m_node(nullptr) {if (other.m_node) m_node = cJSON_Duplicate(other.m_node, true);};
-    CJson(CJson &&other) : m_owner(other.m_owner), m_node(other.m_node) {other.m_node = nullptr;};
+    CJson(cJSON *c_json, bool owner = true) : m_owner(owner), m_node(c_json), m_document() {};
+    CJson(const CJson &other) : m_owner(true), m_node(nullptr), m_document() {if (other.m_node) m_node = cJSON_Duplicate(other.m_node, true);};
+    CJson(CJson &&other) : m_owner(other.m_owner), m_node(other.m_node), m_document(std::move(other.m_document)) {other.m_node = nullptr;};
 
     static CJson newObject() {return CJson(cJSON_CreateObject()); };
     static CJson newArray() {return CJson(cJSON_CreateArray()); };
@@ -88,14 +103,104 @@ public:
         return CJson(json);
     }
 
+    /* Parse into a retained document. Nodes taken from the result share
+     * ownership of the whole tree (see document()) so values can be
+     * referenced in place, e.g. by BorrowedString, after the result and
+     * the input string have gone. */
+    static CJson parseRetained(const std::string &json_string) {
+        cJSON *json = cJSON_Parse(json_string.c_str());
+        if (!json) {
+            throw ModelException("Unable to parse JSON", "CJson", std::string(), ProblemCause::INVALID_MSG_FORMAT);
+        }
+        return CJson(json, std::shared_ptr<const cJSON>(json, [](const cJSON *node) { cJSON_Delete(const_cast<cJSON*>(node)); }));
+    }
+
+    /* Incremental parser for a document which arrives in chunks, such as a
+     * chunked request body. Each chunk is parsed as soon as it is fed in
+     * and only a partially received token is carried over to the next
+     * call, so the whole body never has to be gathered into one buffer.
+     * finish() gives the same document as parse() would for the
+     * concatenated input, ready to pass to a model constructor, and
+     * rejects the same inputs. So, as cJSON_Parse() does, it skips a UTF-8
+     * byte order mark at the start, treats any control character as
+     * whitespace and allows them in strings, reads numbers as far as
+     * strtod() accepts them (so "01" and "1." are numbers), reads a "\u"
+     * escape with invalid hex digits as U+0000 (which ends the string) and
+     * ignores anything after the first complete value or a NUL.
+     *
+     *   CJson::PushParser parser;
+     *   for (each chunk received) parser.feed(chunk);
+     *   Foo foo(parser.finish());
+     */
+    class PushParser {
+    public:
+        PushParser();
+        PushParser(const PushParser&) = delete;
+        PushParser &operator=(const PushParser&) = delete;
+        virtual ~PushParser();
+
+        /* Parse the next chunk, throws ModelException if it is not valid */
+        void feed(const char *data, std::size_t length);
+        void feed(std::string_view chunk) { feed(chunk.data(), chunk.size()); };
+
+        /* true once a complete document has been received, anything fed
+         * after it is ignored */
+        bool complete() const;
+
+        /* Take the parsed document and reset the parser for the next one,
+         * throws ModelException if the document is incomplete */
+        CJson finish();
+
+        /* Discard any partial document */
+        void reset();
+
+    private:
+        enum class State {
+            START,          /* expecting a byte order mark or a value */
+            VALUE,          /* expecting a value */
+            VALUE_OR_END,   /* after '[' */
+            KEY,            /* after ',' in an object */
+            KEY_OR_END,     /* after '{' */
+            COLON,
+            COMMA_OR_END,
+            STRING,
+            NUMBER,
+            LITERAL,
+            DONE,
+            FAILED
+        };
+
+        void fail();
+        void startValue(char c);
+        void addValue(cJSON *item);
+        void endContainer(char c);
+        void endString();
+        void endNumber();
+        void endLiteral();
+
+        State m_state;
+        cJSON *m_root;
+        std::vector<cJSON*> m_stack;    /* open arrays and objects */
+        std::string m_token;            /* partial string, number, literal or byte order mark */
+        std::string m_key;              /* object member name for next value */
+        bool m_isKey;
+        bool m_escape;
+    };
+
     static CJson wrap(int val, bool as_request = false) { return CJson(cJSON_CreateNumber(val)); };
     static CJson wrap(long int val, bool as_request = false) { return CJson(cJSON_CreateNumber(val)); };
     static CJson wrap(long long int val, bool as_request = false) { return CJson(cJSON_CreateNumber(val)); };
     static CJson wrap(float val, bool as_request = false) { return CJson(cJSON_CreateNumber(val)); };
     static CJson wrap(double val, bool as_request = false) { return CJson(cJSON_CreateNumber(val)); };
     static CJson wrap(const std::string &val, bool as_request = false) { return CJson(cJSON_CreateString(val.c_str())); };
-    static CJson wrap(const std::basic_string<unsigned char> &val, bool as_request = false) { return CJson(cJSON_CreateString(reinterpret_cast<const char *>(val.c_str()))); };
+    /* ByteArray values are base64 encoded */
+    static CJson wrap(const std::basic_string<unsigned char> &val, bool as_request = false);
     static CJson wrap(const char *val, bool as_request = false) { return CJson(cJSON_CreateString(val)); };
+    static CJson wrap(const InternedString &val, bool as_request = false);
+    static CJson wrap(const DateTime &val, bool as_request = false);
+    static CJson wrap(const Date &val, bool as_request = false);
+    static CJson wrap(const BasicBorrowedString<char> &val, bool as_request = false);
+    static CJson wrap(const BasicBorrowedString<unsigned char> &val, bool as_request = false);
     static CJson wrap(bool val, bool as_request = false) { return CJson(cJSON_CreateBool(val)); };
     static CJson wrap(const ModelObject &obj, bool as_request = false);
     static CJson wrap(const ModelObject *ptr, bool as_request = false);
@@ -111,17 +216,21 @@ public:
         if (m_owner && m_node) cJSON_Delete(m_node);
         m_node = cJSON_Duplicate(other.m_node, 1);
         m_owner = true;
+        m_document.reset();
+        return *this;
     }
 
     CJson &operator=(CJson &&other) {
         if (m_node == other.m_node) {
             m_owner = m_owner || other.m_owner;
             other.m_owner = false;
+            if (!m_document) m_document = std::move(other.m_document);
             return *this;
         }
         if (m_owner && m_node) cJSON_Delete(m_node);
         m_node = other.m_node;
         m_owner = other.m_owner;
+        m_document = std::move(other.m_document);
         other.m_owner = false;
         return *this;
     }
@@ -142,7 +251,17 @@ public:
     bool isNull() const {return m_node == nullptr || cJSON_IsNull(m_node);};
 
     std::size_t arraySize() const {return (isArray() || isObject())?cJSON_GetArraySize(m_node):0;};
-    CJson index(std::size_t idx) const { return (idx < arraySize())?CJson(cJSON_GetArrayItem(m_node, idx), false):Null; };
+    CJson index(std::size_t idx) const { return (idx < arraySize())?CJson(cJSON_GetArrayItem(m_node, idx), m_document):Null; };
+
+    /* All elements of an array (or members of an object) in a single pass,
+     * for random access. The elements are not owned and are only valid
+     * while this node exists. */
+    std::vector<CJson> elements() const {
+        std::vector<CJson> ret;
+        ret.reserve(arraySize());
+        for (cJSON *child = firstChild(); child; child = child->next) ret.push_back(CJson(child, m_document));
+        return ret;
+    };
 
     CJson &set(const std::string &key, const CJson &node) {
         return set(key, std::move(CJson(node)));
@@ -197,6 +316,10 @@ public:
     };
         
 
+    /* Apply an RFC 7396 JSON Merge Patch to this node, object members are
+     * merged in place, any other patch value replaces this node */
+    void mergePatch(const CJson &patch);
+
     const char *stringValue() const { return isString()?cJSON_GetStringValue(m_node):nullptr; };
     double numberValue() const { return isNumber()?cJSON_GetNumberValue(m_node):NAN; };
     bool boolValue() const { return isBool()?cJSON_IsTrue(m_node):false; };
@@ -209,13 +332,14 @@ public:
     operator float() const { if (!isNumber()) throw ModelException("Attempt to access non-number as floating point", "CJson", std::string(), ProblemCause::INVALID_MSG_FORMAT); return static_cast<float>(numberValue()); };
     operator double() const { if (!isNumber()) throw ModelException("Attempt to access non-number as floating point", "CJson", std::string(), ProblemCause::INVALID_MSG_FORMAT); return numberValue(); };
     operator std::string() const { if (!isString()) throw ModelException("Attempt to access non-string value as string", "CJson", std::string(), ProblemCause::INVALID_MSG_FORMAT); return std::string(stringValue()); };
-    operator std::basic_string<unsigned char>() const { if (!isString()) throw ModelException("Attempt to access non-string value as string", "CJson", std::string(), ProblemCause::INVALID_MSG_FORMAT); return std::basic_string<unsigned char>(reinterpret_cast<const unsigned char*>(stringValue())); };
+    /* Decodes a base64 string as a ByteArray value */
+    operator std::basic_string<unsigned char>() const;
     operator const char*() const { if (!isString()) throw ModelException("Attempt to access non-string value as string", "CJson", std::string(), ProblemCause::INVALID_MSG_FORMAT); return stringValue(); };
     operator bool() const { if (!isBool()) throw ModelException("Attempt to access non-boolean value as boolean", "CJson", std::string(), ProblemCause::INVALID_MSG_FORMAT); return boolValue(); };
 
     CJson getObjectItemCaseSensitive(const std::string &key) const {
         if (isObject()) {
-            return CJson(cJSON_GetObjectItemCaseSensitive(m_node, key.c_str()), false);
+            return CJson(cJSON_GetObjectItemCaseSensitive(m_node, key.c_str()), m_document);
         }
         return Null;
     };
@@ -227,6 +351,10 @@ public:
         return cJSON_Compare(m_node, other.m_node, 1) != 0;
     };
 
+    /* Hash consistent with operator==, object members may be in any order
+     * and numbers do not affect the hash */
+    std::size_t hash() const;
+
     std::string serialise() const {
         if (!m_node) return std::string("null");
         char *str = cJSON_Print(m_node);
@@ -240,11 +368,18 @@ public:
         return m_node;
     };
 
+    /* The retained document this node belongs to, empty unless it came
+     * from parseRetained() */
+    const std::shared_ptr<const cJSON> &document() const { return m_document; };
+
 private:
     CJson();
+    cJSON *firstChild() const {return (isArray() || isObject())?m_node->child:nullptr;};
+    CJson(cJSON *c_json, const std::shared_ptr<const cJSON> &document) : m_owner(false), m_node(c_json), m_document(c_json?document:nullptr) {};
 
     bool m_owner;
     cJSON *m_node;
+    std::shared_ptr<const cJSON> m_document;
 };
 
 } /* end namespace */
@@ -0,0 +1,165 @@
+/**************************************************************************
+ * Composed.hh : Choosing between the alternatives of composed schemas
+ **************************************************************************
+ * The generated anyOf and oneOf models decide which alternative a JSON
+ * value belongs to before decoding it, rather than attempting to decode
+ * each alternative in turn and catching the exceptions. The decision is
+ * taken from the discriminator, when the schema has one, and otherwise
+ * from the signature of the value:
+ *   - models answer for themselves via their static jsonSignatureMatches(),
+ *     for objects this checks the required members are present, for strings
+ *     it checks the patterns or enumerated values.
+ *   - everything else is decided by the type of the JSON value.
+ * Members an object model does not know do not stop it matching, as they
+ * are ignored when it is decoded. When more than one oneOf alternative
+ * matches, the one with the fewest unknown members is chosen.
+ **************************************************************************
+ * License: 5G-MAG Public License (v1.0)
+ * Author: David Waring
+ * Copyright: (C)2025 British Broadcasting Corporation
+ *
+ * For full license terms please see the LICENSE file distributed with this
+ * program. If this file is missing then the license can be retrieved from
+ * https://drive.google.com/file/d/1cinCiA778IErENZ3JN52VFW-1ffHpx7Z/view
+ */
+
+#ifndef _OPENAPI_COMPOSED_HH_
+#define _OPENAPI_COMPOSED_HH_
+
+#include <concepts>
+#include <cstddef>
+#include <list>
+#include <map>
+#include <memory>
+#include <optional>
+#include <type_traits>
+
+#include "CJson.hh"
+#include "ModelObject.hh"
+
+namespace fiveg_mag_reftools {
+
+template <class T>
+struct JsonSignature {
+    static bool matches(const CJson &json, bool as_request) {
+        if constexpr (requires { { T::jsonSignatureMatches(json, as_request) } -> std::convertible_to<bool>; }) {
+            /* models and AnyType */
+            return T::jsonSignatureMatches(json, as_request);
+        } else if constexpr (std::is_same_v<T, bool>) {
+            return json.isBool();
+        } else if constexpr (std::is_arithmetic_v<T>) {
+            return json.isNumber();
+        } else {
+            /* strings, byte arrays, dates and times */
+            return json.isString();
+        }
+    };
+
+    static std::size_t unknownMembers(const CJson &json) {
+        if constexpr (requires { { T::jsonUnknownMembers(json) } -> std::convertible_to<std::size_t>; }) {
+            return T::jsonUnknownMembers(json);
+        } else {
+            return 0;
+        }
+    };
+};
+
+template <class T>
+struct JsonSignature<std::optional<T> > : JsonSignature<T> {};
+
+template <class T>
+struct JsonSignature<std::shared_ptr<T> > : JsonSignature<T> {};
+
+template <class T, class A>
+struct JsonSignature<std::list<T, A> > {
+    static bool matches(const CJson &json, [[maybe_unused]] bool as_request) { return json.isArray(); };
+    static std::size_t unknownMembers([[maybe_unused]] const CJson &json) { return 0; };
+};
+
+template <class K, class T, class C, class A>
+struct JsonSignature<std::map<K, T, C, A> > {
+    static bool matches(const CJson &json, [[maybe_unused]] bool as_request) { return json.isObject(); };
+    static std::size_t unknownMembers([[maybe_unused]] const CJson &json) { return 0; };
+};
+
+/* Could json be decoded as a value of type T, without trying to decode it */
+template <class T>
+bool jsonSignatureMatches(const CJson &json, bool as_request = true)
+{
+    return JsonSignature<T>::matches(json, as_request);
+}
+
+/* How many members of json an object model of type T does not know, 0 for
+ * any other type */
+template <class T>
+std::size_t jsonUnknownMembers(const CJson &json)
+{
+    return JsonSignature<T>::unknownMembers(json);
+}
+
+/* Chooses between the alternatives of a oneOf, each is offered in turn with
+ * its (1-based) index. Alternatives with fewer unknown members win, more
+ * than one match is left if they tie. */
+class OneOfChooser {
+public:
+    OneOfChooser() :m_alternative(0), m_matches(0), m_fewestUnknown(0) {};
+
+    template <class T>
+    void consider(std::size_t alternative, const CJson &json, bool as_request) {
+        if (!jsonSignatureMatches<T>(json, as_request)) return;
+        std::size_t unknown = jsonUnknownMembers<T>(json);
+        if (m_matches == 0 || unknown < m_fewestUnknown) {
+            m_alternative = alternative;
+            m_matches = 1;
+            m_fewestUnknown = unknown;
+        } else if (unknown == m_fewestUnknown) {
+            m_matches++;
+        }
+    };
+
+    /* The chosen alternative, only meaningful if matches() is 1 */
+    std::size_t alternative() const { return m_alternative; };
+    std::size_t matches() const { return m_matches; };
+
+private:
+    std::size_t m_alternative;
+    std::size_t m_matches;
+    std::size_t m_fewestUnknown;
+};
+
+/* Merge an RFC 7396 JSON Merge Patch into an alternative which is already
+ * set, so that members its JSON encoding leaves out (read-only in a
+ * request, write-only in a response) are kept. Only an object model which
+ * knows every member of the patch is merged into, otherwise false is
+ * returned and the alternative should be decoded from the merged JSON. */
+template <class T>
+bool mergePatchAlternative([[maybe_unused]] T &alternative, [[maybe_unused]] const CJson &patch)
+{
+    return false;
+}
+
+template <class T>
+bool mergePatchAlternative(std::shared_ptr<T> &alternative, const CJson &patch)
+{
+    if constexpr (requires { alternative->applyMergePatch(patch); }) {
+        if (!alternative || !patch.isObject() || jsonUnknownMembers<T>(patch) != 0) return false;
+        copyOnWrite(alternative);
+        alternative->applyMergePatch(patch);
+        return true;
+    } else {
+        return false;
+    }
+}
+
+template <class T>
+bool mergePatchAlternative(std::optional<T> &alternative, const CJson &patch)
+{
+    return alternative.has_value() && mergePatchAlternative(alternative.value(), patch);
+}
+
+} /* end namespace */
+
+/* vim:ts=8:sts=4:sw=4:expandtab:
+ */
+
+#endif /* _OPENAPI_COMPOSED_HH_ */
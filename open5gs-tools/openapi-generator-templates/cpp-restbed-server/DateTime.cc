@@ -0,0 +1,350 @@
+/**************************************************************************
+ * DateTime.cc : Compact date and date-time values
+ **************************************************************************
+ * Hand written RFC 3339 parsing and formatting. The calendar conversions
+ * use the proleptic Gregorian days-from-civil algorithms, so no time zone
+ * database or locale is involved.
+ *
+ * A leap second (":60") is accepted and is folded into the following
+ * second.
+ **************************************************************************
+ * License: 5G-MAG Public License (v1.0)
+ * Author: David Waring
+ * Copyright: (C)2025 British Broadcasting Corporation
+ *
+ * For full license terms please see the LICENSE file distributed with this
+ * program. If this file is missing then the license can be retrieved from
+ * https://drive.google.com/file/d/1cinCiA778IErENZ3JN52VFW-1ffHpx7Z/view
+ */
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "CJson.hh"
+#include "ModelException.hh"
+#include "ProblemCause.hh"
+#include "DateTime.hh"
+
+namespace fiveg_mag_reftools {
+
+namespace {
+
+constexpr std::int64_t NanosPerSecond = 1000000000LL;
+constexpr std::int64_t SecondsPerDay = 86400;
+
+constexpr std::int64_t Pow10[] = {
+    1LL, 10LL, 100LL, 1000LL, 10000LL, 100000LL, 1000000LL, 10000000LL, 100000000LL, 1000000000LL
+};
+
+std::int64_t daysFromCivil(std::int64_t y, unsigned m, unsigned d)
+{
+    y -= m <= 2;
+    const std::int64_t era = (y >= 0 ? y : y - 399) / 400;
+    const unsigned yoe = static_cast<unsigned>(y - era * 400);
+    const unsigned doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + static_cast<std::int64_t>(doe) - 719468;
+}
+
+void civilFromDays(std::int64_t z, std::int64_t &y, unsigned &m, unsigned &d)
+{
+    z += 719468;
+    const std::int64_t era = (z >= 0 ? z : z - 146096) / 146097;
+    const unsigned doe = static_cast<unsigned>(z - era * 146097);
+    const unsigned yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    const unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    const unsigned mp = (5 * doy + 2) / 153;
+    d = doy - (153 * mp + 2) / 5 + 1;
+    m = mp < 10 ? mp + 3 : mp - 9;
+    y = static_cast<std::int64_t>(yoe) + era * 400 + (m <= 2);
+}
+
+bool isLeapYear(std::int64_t y)
+{
+    return (y % 4 == 0) && (y % 100 != 0 || y % 400 == 0);
+}
+
+unsigned daysInMonth(std::int64_t y, unsigned m)
+{
+    static const unsigned days[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    return (m == 2 && isLeapYear(y)) ? 29 : days[m - 1];
+}
+
+std::int64_t floorDiv(std::int64_t a, std::int64_t b)
+{
+    std::int64_t q = a / b;
+    if ((a % b != 0) && ((a < 0) != (b < 0))) q--;
+    return q;
+}
+
+/* Read exactly n digits from value at pos */
+bool digits(std::string_view value, std::size_t &pos, unsigned n, unsigned &result)
+{
+    if (value.size() < pos + n) return false;
+    result = 0;
+    for (unsigned i = 0; i < n; i++) {
+        char c = value[pos + i];
+        if (c < '0' || c > '9') return false;
+        result = result * 10 + static_cast<unsigned>(c - '0');
+    }
+    pos += n;
+    return true;
+}
+
+bool expect(std::string_view value, std::size_t &pos, char c)
+{
+    if (pos >= value.size() || value[pos] != c) return false;
+    pos++;
+    return true;
+}
+
+/* full-date = date-fullyear "-" date-month "-" date-mday */
+bool parseFullDate(std::string_view value, std::size_t &pos, std::int64_t &days)
+{
+    unsigned year, month, day;
+    if (!digits(value, pos, 4, year) || !expect(value, pos, '-') ||
+        !digits(value, pos, 2, month) || !expect(value, pos, '-') ||
+        !digits(value, pos, 2, day)) return false;
+    if (month < 1 || month > 12) return false;
+    if (day < 1 || day > daysInMonth(year, month)) return false;
+    days = daysFromCivil(year, month, day);
+    return true;
+}
+
+void put2(std::string &out, unsigned value)
+{
+    out.push_back(static_cast<char>('0' + value / 10));
+    out.push_back(static_cast<char>('0' + value % 10));
+}
+
+void putDate(std::string &out, std::int64_t days)
+{
+    std::int64_t y;
+    unsigned m, d;
+    civilFromDays(days, y, m, d);
+    if (y >= 0 && y <= 9999) {
+        unsigned year = static_cast<unsigned>(y);
+        put2(out, year / 100);
+        put2(out, year % 100);
+    } else {
+        /* Outside the years RFC 3339 allows (only reachable from a
+         * time_point or a UTC offset moving the date over the edge), so
+         * write the signed, expanded year of ISO 8601 */
+        out.push_back(y < 0 ? '-' : '+');
+        std::string year = std::to_string(y < 0 ? -static_cast<std::uint64_t>(y) : static_cast<std::uint64_t>(y));
+        if (year.size() < 4) out.append(4 - year.size(), '0');
+        out.append(year);
+    }
+    out.push_back('-');
+    put2(out, m);
+    out.push_back('-');
+    put2(out, d);
+}
+
+} /* end anonymous namespace */
+
+DateTime::DateTime(std::string_view rfc3339)
+    :DateTime()
+{
+    if (!parse(rfc3339, *this)) {
+        throw ModelException("Value is not a valid RFC 3339 date-time", "DateTime", std::string(), ProblemCause::INVALID_MSG_FORMAT);
+    }
+}
+
+DateTime::DateTime(const CJson &json)
+    :DateTime()
+{
+    const char *value = json.stringValue();
+    if (!value) throw ModelException("Attempt to access non-string value as date-time", "CJson", std::string(), ProblemCause::INVALID_MSG_FORMAT);
+    if (!parse(std::string_view(value), *this)) {
+        throw ModelException("Value is not a valid RFC 3339 date-time", "DateTime", std::string(), ProblemCause::INVALID_MSG_FORMAT);
+    }
+}
+
+DateTime::DateTime(const time_point &instant, int offset_minutes)
+    :m_seconds(floorDiv(instant.time_since_epoch().count(), NanosPerSecond))
+    ,m_nanoseconds(static_cast<std::uint32_t>(instant.time_since_epoch().count() - m_seconds * NanosPerSecond))
+    ,m_offsetMinutes(static_cast<std::int16_t>(offset_minutes))
+    ,m_fractionDigits(0)
+    ,m_flags(offset_minutes?0:FLAG_ZULU)
+{
+    std::uint32_t frac = m_nanoseconds;
+    if (frac) {
+        m_fractionDigits = 9;
+        while (m_fractionDigits > 0 && frac % 10 == 0) {
+            frac /= 10;
+            m_fractionDigits--;
+        }
+    }
+}
+
+DateTime DateTime::now()
+{
+    return DateTime(std::chrono::time_point_cast<duration>(std::chrono::system_clock::now()));
+}
+
+DateTime DateTime::withOffset(int offset_minutes) const
+{
+    DateTime ret(*this);
+    ret.m_offsetMinutes = static_cast<std::int16_t>(offset_minutes);
+    ret.m_flags = offset_minutes?0:FLAG_ZULU;
+    return ret;
+}
+
+/* date-time = full-date ("T" / "t" / " ") partial-time time-offset */
+bool DateTime::parse(std::string_view value, DateTime &result) noexcept
+{
+    std::size_t pos = 0;
+    std::int64_t days;
+    unsigned hour, minute, second;
+
+    if (!parseFullDate(value, pos, days)) return false;
+    if (pos >= value.size() || (value[pos] != 'T' && value[pos] != 't' && value[pos] != ' ')) return false;
+    pos++;
+    if (!digits(value, pos, 2, hour) || !expect(value, pos, ':') ||
+        !digits(value, pos, 2, minute) || !expect(value, pos, ':') ||
+        !digits(value, pos, 2, second)) return false;
+    if (hour > 23 || minute > 59 || second > 60) return false;
+
+    std::int64_t fraction = 0;
+    unsigned fraction_digits = 0;
+    if (pos < value.size() && value[pos] == '.') {
+        pos++;
+        std::size_t start = pos;
+        while (pos < value.size() && value[pos] >= '0' && value[pos] <= '9') {
+            if (pos - start < 9) {
+                fraction = fraction * 10 + (value[pos] - '0');
+                fraction_digits++;
+            }
+            pos++;
+        }
+        if (pos == start) return false;
+        fraction *= Pow10[9 - fraction_digits];
+    }
+
+    int offset = 0;
+    std::uint8_t flags = 0;
+    if (pos >= value.size()) return false;
+    if (value[pos] == 'Z' || value[pos] == 'z') {
+        flags = FLAG_ZULU;
+        pos++;
+    } else if (value[pos] == '+' || value[pos] == '-') {
+        bool negative = value[pos] == '-';
+        unsigned off_hour, off_minute;
+        pos++;
+        if (!digits(value, pos, 2, off_hour) || !expect(value, pos, ':') || !digits(value, pos, 2, off_minute)) return false;
+        if (off_hour > 23 || off_minute > 59) return false;
+        offset = static_cast<int>(off_hour * 60 + off_minute);
+        if (negative) {
+            if (offset == 0) flags = FLAG_UNKNOWN_OFFSET;
+            offset = -offset;
+        }
+    } else {
+        return false;
+    }
+    if (pos != value.size()) return false;
+
+    /* local time to UTC */
+    result.m_seconds = days * SecondsPerDay + hour * 3600 + minute * 60 + second - offset * 60;
+    result.m_nanoseconds = static_cast<std::uint32_t>(fraction);
+    result.m_offsetMinutes = static_cast<std::int16_t>(offset);
+    result.m_fractionDigits = static_cast<std::uint8_t>(fraction_digits);
+    result.m_flags = flags;
+    return true;
+}
+
+std::string DateTime::str() const
+{
+    std::string out;
+    out.reserve(35);
+
+    std::int64_t local = m_seconds + m_offsetMinutes * 60;
+    std::int64_t days = floorDiv(local, SecondsPerDay);
+    unsigned day_seconds = static_cast<unsigned>(local - days * SecondsPerDay);
+    std::int64_t fraction = m_nanoseconds;
+
+    putDate(out, days);
+    out.push_back('T');
+    put2(out, day_seconds / 3600);
+    out.push_back(':');
+    put2(out, (day_seconds / 60) % 60);
+    out.push_back(':');
+    put2(out, day_seconds % 60);
+
+    if (m_fractionDigits) {
+        char buf[9];
+        std::int64_t scaled = fraction / Pow10[9 - m_fractionDigits];
+        for (int i = m_fractionDigits - 1; i >= 0; i--) {
+            buf[i] = static_cast<char>('0' + scaled % 10);
+            scaled /= 10;
+        }
+        out.push_back('.');
+        out.append(buf, m_fractionDigits);
+    }
+
+    if (m_flags & FLAG_ZULU) {
+        out.push_back('Z');
+    } else {
+        int offset = m_offsetMinutes;
+        out.push_back((offset < 0 || (m_flags & FLAG_UNKNOWN_OFFSET)) ? '-' : '+');
+        if (offset < 0) offset = -offset;
+        put2(out, static_cast<unsigned>(offset / 60));
+        out.push_back(':');
+        put2(out, static_cast<unsigned>(offset % 60));
+    }
+
+    return out;
+}
+
+Date::Date(std::string_view rfc3339)
+    :m_days(0)
+{
+    if (!parse(rfc3339, *this)) {
+        throw ModelException("Value is not a valid RFC 3339 full-date", "Date", std::string(), ProblemCause::INVALID_MSG_FORMAT);
+    }
+}
+
+Date::Date(const CJson &json)
+    :m_days(0)
+{
+    const char *value = json.stringValue();
+    if (!value) throw ModelException("Attempt to access non-string value as date", "CJson", std::string(), ProblemCause::INVALID_MSG_FORMAT);
+    if (!parse(std::string_view(value), *this)) {
+        throw ModelException("Value is not a valid RFC 3339 full-date", "Date", std::string(), ProblemCause::INVALID_MSG_FORMAT);
+    }
+}
+
+Date::Date(int year, unsigned month, unsigned day)
+    :m_days(0)
+{
+    if (year < 0 || year > 9999 || month < 1 || month > 12 || day < 1 || day > daysInMonth(year, month)) {
+        throw ModelException("Invalid calendar date", "Date", std::string(), ProblemCause::INVALID_MSG_FORMAT);
+    }
+    m_days = static_cast<std::int32_t>(daysFromCivil(year, month, day));
+}
+
+bool Date::parse(std::string_view value, Date &result) noexcept
+{
+    std::size_t pos = 0;
+    std::int64_t days;
+
+    if (!parseFullDate(value, pos, days) || pos != value.size()) return false;
+
+    result.m_days = static_cast<std::int32_t>(days);
+    return true;
+}
+
+std::string Date::str() const
+{
+    std::string out;
+    out.reserve(10);
+    putDate(out, m_days);
+    return out;
+}
+
+} /* end namespace */
+
+/* vim:ts=8:sts=4:sw=4:expandtab:
+ */
@@ -0,0 +1,144 @@
+/**************************************************************************
+ * DateTime.hh : Compact date and date-time values
+ **************************************************************************
+ * DateTime holds an RFC 3339 date-time as seconds and nanoseconds since the
+ * UNIX epoch, which covers every year from 0000 to 9999 that RFC 3339 can
+ * express, along with the UTC offset it was given in, so that it can be
+ * formatted back the same way. Comparisons are by instant, so values with different
+ * UTC offsets compare correctly.
+ *
+ * Date holds an RFC 3339 full-date as a count of days since the UNIX
+ * epoch.
+ *
+ * These are used for "date" and "date-time" format string properties.
+ **************************************************************************
+ * License: 5G-MAG Public License (v1.0)
+ * Author: David Waring
+ * Copyright: (C)2025 British Broadcasting Corporation
+ *
+ * For full license terms please see the LICENSE file distributed with this
+ * program. If this file is missing then the license can be retrieved from
+ * https://drive.google.com/file/d/1cinCiA778IErENZ3JN52VFW-1ffHpx7Z/view
+ */
+
+#ifndef _OPENAPI_DATE_TIME_HH_
+#define _OPENAPI_DATE_TIME_HH_
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+namespace fiveg_mag_reftools {
+
+class CJson;
+
+class DateTime {
+public:
+    typedef std::chrono::nanoseconds duration;
+    typedef std::chrono::time_point<std::chrono::system_clock, duration> time_point;
+
+    DateTime() :m_seconds(0) ,m_nanoseconds(0) ,m_offsetMinutes(0) ,m_fractionDigits(0) ,m_flags(FLAG_ZULU) {};
+    explicit DateTime(std::string_view rfc3339);
+    explicit DateTime(const std::string &rfc3339) :DateTime(std::string_view(rfc3339)) {};
+    explicit DateTime(const char *rfc3339) :DateTime(std::string_view(rfc3339)) {};
+    explicit DateTime(const CJson &json);
+    explicit DateTime(const time_point &instant, int offset_minutes = 0);
+    DateTime(const DateTime &other) = default;
+    DateTime &operator=(const DateTime &other) = default;
+
+    static DateTime now();
+
+    /* Parse an RFC 3339 date-time, returns false if value is not valid */
+    static bool parse(std::string_view value, DateTime &result) noexcept;
+
+    std::string str() const;
+
+    /* The instant as a time_point, only valid for years 1678 to 2262 as
+     * time_point counts nanoseconds in 64 bits */
+    time_point timePoint() const { return time_point(std::chrono::seconds(m_seconds) + duration(m_nanoseconds)); };
+    std::int64_t secondsSinceEpoch() const { return m_seconds; };
+    std::uint32_t nanoseconds() const { return m_nanoseconds; };   /* within the second */
+    int offsetMinutes() const { return m_offsetMinutes; };
+
+    /* Return the same instant expressed with a different UTC offset */
+    DateTime withOffset(int offset_minutes) const;
+
+    bool operator==(const DateTime &other) const { return m_seconds == other.m_seconds && m_nanoseconds == other.m_nanoseconds; };
+    bool operator!=(const DateTime &other) const { return !(*this == other); };
+    bool operator<(const DateTime &other) const { return m_seconds < other.m_seconds || (m_seconds == other.m_seconds && m_nanoseconds < other.m_nanoseconds); };
+    bool operator<=(const DateTime &other) const { return !(other < *this); };
+    bool operator>(const DateTime &other) const { return other < *this; };
+    bool operator>=(const DateTime &other) const { return !(*this < other); };
+
+    std::size_t hash() const { return std::hash<std::uint64_t>()(static_cast<std::uint64_t>(m_seconds) * 1000000000ULL + m_nanoseconds); };
+
+private:
+    enum {
+        FLAG_ZULU = 1,              /* offset was given as "Z" */
+        FLAG_UNKNOWN_OFFSET = 2     /* offset was given as "-00:00" */
+    };
+
+    std::int64_t m_seconds;         /* UTC seconds since the UNIX epoch */
+    std::uint32_t m_nanoseconds;    /* 0 to 999999999 */
+    std::int16_t m_offsetMinutes;
+    std::uint8_t m_fractionDigits;  /* number of fractional second digits to format */
+    std::uint8_t m_flags;
+};
+
+class Date {
+public:
+    typedef std::chrono::time_point<std::chrono::system_clock, std::chrono::days> time_point;
+
+    Date() :m_days(0) {};
+    explicit Date(std::string_view rfc3339);
+    explicit Date(const std::string &rfc3339) :Date(std::string_view(rfc3339)) {};
+    explicit Date(const char *rfc3339) :Date(std::string_view(rfc3339)) {};
+    explicit Date(const CJson &json);
+    explicit Date(const time_point &day) :m_days(static_cast<std::int32_t>(day.time_since_epoch().count())) {};
+    Date(int year, unsigned month, unsigned day);
+    Date(const Date &other) = default;
+    Date &operator=(const Date &other) = default;
+
+    /* Parse an RFC 3339 full-date, returns false if value is not valid */
+    static bool parse(std::string_view value, Date &result) noexcept;
+
+    std::string str() const;
+
+    time_point timePoint() const { return time_point(std::chrono::days(m_days)); };
+    std::int32_t daysSinceEpoch() const { return m_days; };
+
+    bool operator==(const Date &other) const { return m_days == other.m_days; };
+    bool operator!=(const Date &other) const { return m_days != other.m_days; };
+    bool operator<(const Date &other) const { return m_days < other.m_days; };
+    bool operator<=(const Date &other) const { return m_days <= other.m_days; };
+    bool operator>(const Date &other) const { return m_days > other.m_days; };
+    bool operator>=(const Date &other) const { return m_days >= other.m_days; };
+
+    std::size_t hash() const { return std::hash<std::int32_t>()(m_days); };
+
+private:
+    std::int32_t m_days;
+};
+
+inline std::ostream &operator<<(std::ostream &os, const DateTime &dt) { return os << dt.str(); }
+inline std::ostream &operator<<(std::ostream &os, const Date &date) { return os << date.str(); }
+
+} /* end namespace */
+
+template <>
+struct std::hash<fiveg_mag_reftools::DateTime> {
+    std::size_t operator()(const fiveg_mag_reftools::DateTime &dt) const noexcept { return dt.hash(); };
+};
+
+template <>
+struct std::hash<fiveg_mag_reftools::Date> {
+    std::size_t operator()(const fiveg_mag_reftools::Date &date) const noexcept { return date.hash(); };
+};
+
+/* vim:ts=8:sts=4:sw=4:expandtab:
+ */
+
+#endif /* _OPENAPI_DATE_TIME_HH_ */
@@ -0,0 +1,165 @@
+/**************************************************************************
+ * FieldCodec.cc : Table driven JSON codec for generated object models
+ **************************************************************************
+ * License: 5G-MAG Public License (v1.0)
+ * Author: David Waring
+ * Copyright: (C)2025 British Broadcasting Corporation
+ *
+ * For full license terms please see the LICENSE file distributed with this
+ * program. If this file is missing then the license can be retrieved from
+ * https://drive.google.com/file/d/1cinCiA778IErENZ3JN52VFW-1ffHpx7Z/view
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "CJson.hh"
+#include "ModelException.hh"
+#include "ModelHash.hh"
+#include "ModelObject.hh"
+#include "ProblemCause.hh"
+
+#include "FieldCodec.hh"
+
+namespace fiveg_mag_reftools {
+
+namespace {
+
+/* The set of fields seen while decoding, without allocating for the
+ * usual case of no more than 64 fields */
+class SeenFields {
+public:
+    SeenFields(std::size_t count) :m_bits(0), m_large(count > 64 ? count : 0) {};
+
+    /* Marks field idx as seen, returns false if it already was */
+    bool mark(std::size_t idx) {
+        if (m_large.empty()) {
+            std::uint64_t bit = std::uint64_t(1) << idx;
+            if (m_bits & bit) return false;
+            m_bits |= bit;
+        } else {
+            if (m_large[idx]) return false;
+            m_large[idx] = true;
+        }
+        return true;
+    };
+
+    bool seen(std::size_t idx) const {
+        return m_large.empty() ? ((m_bits >> idx) & 1) : m_large[idx];
+    };
+
+private:
+    std::uint64_t m_bits;
+    std::vector<bool> m_large;
+};
+
+}
+
+void FieldCodec::fromJSON(const FieldTable &table, ModelObject &obj, const CJson &json, bool as_request)
+{
+    SeenFields seen(table.fields.size());
+
+    if (json.isObject()) {
+        for (auto member : json) {
+            std::size_t idx = table.find(member.key());
+            if (idx == 0) continue;
+            const FieldDescriptor &field = table.fields[idx - 1];
+            /* null members are treated as absent, and the first of any
+             * duplicated members is used */
+            if (!field.appliesTo(as_request) || member.isNull() || !seen.mark(idx - 1)) continue;
+
+            std::string name(field.name);
+            if (field.ops->kind == FieldOps::ARRAY && !member.isArray()) {
+                throw ModelException("Field \"" + name + "\" is not an array", table.classname, name, ProblemCause::INVALID_MSG_FORMAT);
+            }
+            if (field.ops->kind == FieldOps::MAP && !member.isObject()) {
+                throw ModelException("Field \"" + name + "\" is not an object", table.classname, name, ProblemCause::INVALID_MSG_FORMAT);
+            }
+            try {
+                field.ops->decode(field.member(obj), member, as_request);
+            } catch (ModelException &ex) {
+                throw ModelException(ex.what(), table.classname, joinParameter(name, ex.parameter), ex.cause);
+            }
+            field.validate(obj);
+        }
+    }
+
+    for (std::size_t idx = 0; idx < table.fields.size(); idx++) {
+        const FieldDescriptor &field = table.fields[idx];
+        if ((field.flags & FieldDescriptor::REQUIRED) && field.appliesTo(as_request) && !seen.seen(idx)) {
+            std::string name(field.name);
+            throw ModelException("Field \"" + name + "\" is required", table.classname, name, ProblemCause::MANDATORY_IE_MISSING);
+        }
+    }
+}
+
+CJson FieldCodec::toJSON(const FieldTable &table, const ModelObject &obj, bool as_request)
+{
+    CJson object = CJson::newObject();
+
+    for (const auto &field : table.fields) {
+        if (!field.appliesTo(as_request)) continue;
+        std::string name(field.name);
+        if (field.isSet(obj)) {
+            object.set(name, field.toJSON(obj, as_request));
+        } else if (field.flags & FieldDescriptor::REQUIRED) {
+            /* only readOnly and writeOnly required fields can be unset */
+            switch (field.ops->kind) {
+            case FieldOps::ARRAY:
+                object.set(name, CJson::newArray());
+                break;
+            case FieldOps::MAP:
+                object.set(name, CJson::newObject());
+                break;
+            default:
+                throw ModelException("Runtime Error: " + std::string(table.classname) + "." + name + " is mandatory in a " + ((field.flags & FieldDescriptor::READ_ONLY)?"response":"request") + " but is unset", table.classname, name, ProblemCause::SYSTEM_FAILURE);
+            }
+        }
+    }
+
+    return object;
+}
+
+bool FieldCodec::equals(const FieldTable &table, const ModelObject &a, const ModelObject &b)
+{
+    for (const auto &field : table.fields) {
+        if (!field.equals(a, b)) return false;
+    }
+    return true;
+}
+
+std::size_t FieldCodec::hash(const FieldTable &table, const ModelObject &obj)
+{
+    std::size_t seed = 0;
+
+    for (const auto &field : table.fields) {
+        hashCombine(seed, field.hash(obj));
+    }
+    return seed;
+}
+
+bool FieldCodec::validate(const FieldTable &table, const ModelObject &obj)
+{
+    for (const auto &field : table.fields) {
+        if (!field.validate(obj)) return false;
+    }
+    return true;
+}
+
+std::string FieldCodec::joinParameter(std::string_view prefix, std::string_view sub)
+{
+    std::string param(prefix);
+    if (!sub.empty()) {
+        if (sub.front() != '[') param += '.';
+        param += sub;
+    }
+    return param;
+}
+
+} /* end namespace */
+
+/* vim:ts=8:sts=4:sw=4:expandtab:
+ */
@@ -0,0 +1,303 @@
+/**************************************************************************
+ * FieldCodec.hh : Table driven JSON codec for generated object models
+ **************************************************************************
+ * When the "tableDrivenCodec" generator option is set, each object model
+ * describes its fields with a constant-initialised table of
+ * FieldDescriptors instead of expanding the decode, encode, compare, hash
+ * and validate code inline for every field. The FieldCodec routines then
+ * walk the table for every model.
+ *
+ * Each descriptor holds the JSON member name, the required, readOnly and
+ * writeOnly flags, small thunks giving the address of the member (one for
+ * decoding, a const one for encoding, comparing and hashing, and one to
+ * run its validator, which holds the constraints) and the FieldOps for the
+ * C++ type of the member. FieldOps are shared by every field of the same
+ * type across all models, so the container and model handling is
+ * instantiated once per type rather than once per field.
+ **************************************************************************
+ * License: 5G-MAG Public License (v1.0)
+ * Author: David Waring
+ * Copyright: (C)2025 British Broadcasting Corporation
+ *
+ * For full license terms please see the LICENSE file distributed with this
+ * program. If this file is missing then the license can be retrieved from
+ * https://drive.google.com/file/d/1cinCiA778IErENZ3JN52VFW-1ffHpx7Z/view
+ */
+
+#ifndef _OPENAPI_FIELD_CODEC_HH_
+#define _OPENAPI_FIELD_CODEC_HH_
+
+#include <cstddef>
+#include <list>
+#include <map>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "CJson.hh"
+#include "ModelDiff.hh"
+#include "ModelException.hh"
+#include "ModelHash.hh"
+#include "ModelObject.hh"
+#include "ParallelDecode.hh"
+#include "ProblemCause.hh"
+
+namespace fiveg_mag_reftools {
+
+/* Type specific operations on a field, the void pointers are the address
+ * of a member of the C++ type the FieldOps were made for */
+struct FieldOps {
+    enum Kind {
+        SCALAR,
+        ARRAY,
+        MAP
+    };
+
+    Kind kind;
+    void (*decode)(void *member, const CJson &json, bool as_request);
+    CJson (*encode)(const void *member, bool as_request);
+    bool (*isSet)(const void *member);
+    bool (*equals)(const void *a, const void *b);
+    std::size_t (*hash)(const void *member);
+};
+
+struct FieldDescriptor {
+    enum Flags : unsigned {
+        REQUIRED = 1,
+        READ_ONLY = 2,
+        WRITE_ONLY = 4
+    };
+
+    std::string_view name;
+    unsigned flags;
+    const FieldOps *ops;
+    void *(*member)(ModelObject &obj);
+    const void *(*constMember)(const ModelObject &obj);
+    bool (*validate)(const ModelObject &obj);
+
+    /* readOnly fields only appear in responses, writeOnly in requests */
+    bool appliesTo(bool as_request) const {
+        return !(flags & (as_request?READ_ONLY:WRITE_ONLY));
+    };
+
+    /* Operations on this field of obj which leave it unchanged */
+    bool isSet(const ModelObject &obj) const { return ops->isSet(constMember(obj)); };
+    CJson toJSON(const ModelObject &obj, bool as_request) const { return ops->encode(constMember(obj), as_request); };
+    bool equals(const ModelObject &a, const ModelObject &b) const { return ops->equals(constMember(a), constMember(b)); };
+    std::size_t hash(const ModelObject &obj) const { return ops->hash(constMember(obj)); };
+};
+
+struct FieldTable {
+    const char *classname;
+    std::span<const FieldDescriptor> fields;
+    /* 1-based index into fields of the JSON member name, or 0 */
+    std::size_t (*find)(std::string_view name);
+};
+
+class FieldCodec {
+public:
+    static void fromJSON(const FieldTable &table, ModelObject &obj, const CJson &json, bool as_request);
+    static CJson toJSON(const FieldTable &table, const ModelObject &obj, bool as_request);
+    static bool equals(const FieldTable &table, const ModelObject &a, const ModelObject &b);
+    static std::size_t hash(const FieldTable &table, const ModelObject &obj);
+    static bool validate(const FieldTable &table, const ModelObject &obj);
+
+    /* Error parameter for sub (relative to a value) within the value at prefix */
+    static std::string joinParameter(std::string_view prefix, std::string_view sub);
+
+private:
+    FieldCodec() = delete;
+};
+
+/* Decoding and encoding of a whole value, ModelException parameters are
+ * relative to the value */
+template <class T> void decodeValue(T &out, const CJson &json, bool as_request);
+template <class T> void decodeValue(std::shared_ptr<T> &out, const CJson &json, bool as_request);
+template <class T> void decodeValue(std::optional<T> &out, const CJson &json, bool as_request);
+template <class T, class A> void decodeValue(std::list<T, A> &out, const CJson &json, bool as_request);
+template <class T, class C, class A> void decodeValue(std::map<std::string, T, C, A> &out, const CJson &json, bool as_request);
+
+template <class T> CJson encodeValue(const T &value, bool as_request);
+template <class T> CJson encodeValue(const std::shared_ptr<T> &value, bool as_request);
+template <class T> CJson encodeValue(const std::optional<T> &value, bool as_request);
+template <class T, class A> CJson encodeValue(const std::list<T, A> &value, bool as_request);
+template <class T, class C, class A> CJson encodeValue(const std::map<std::string, T, C, A> &value, bool as_request);
+
+template <class T>
+void decodeValue(T &out, const CJson &json, bool as_request)
+{
+    /* strings, numbers, booleans, byte arrays, dates and times */
+    out = static_cast<T>(json);
+}
+
+template <class T>
+void decodeValue(std::shared_ptr<T> &out, const CJson &json, bool as_request)
+{
+    out.reset(new T(json, as_request));
+}
+
+template <class T>
+void decodeValue(std::optional<T> &out, const CJson &json, bool as_request)
+{
+    T value{};
+    decodeValue(value, json, as_request);
+    out = std::move(value);
+}
+
+template <class T, class A>
+void decodeValue(std::list<T, A> &out, const CJson &json, bool as_request)
+{
+    if (!json.isArray()) {
+        throw ModelException("Value is not an array", std::string(), std::string(), ProblemCause::INVALID_MSG_FORMAT);
+    }
+
+    auto decode_element = [as_request](const CJson &var, std::size_t idx, T &element) {
+        try {
+            decodeValue(element, var, as_request);
+        } catch (ModelException &ex) {
+            throw ModelException(ex.what(), ex.classname, FieldCodec::joinParameter("[" + std::to_string(idx) + "]", ex.parameter), ex.cause);
+        }
+    };
+
+    std::list<T, A> items;
+    if (ParallelDecode::enabled() && ParallelDecode::useFor(json.arraySize())) {
+        std::vector<CJson> vars(json.elements());
+        std::vector<T> elements(vars.size());
+        ParallelDecode::forEach(vars.size(), [&](std::size_t idx) { decode_element(vars[idx], idx, elements[idx]); });
+        for (auto &element : elements) items.push_back(std::move(element));
+    } else {
+        std::size_t idx = 0;
+        for (auto var : json) {
+            T element{};
+            decode_element(var, idx++, element);
+            items.push_back(std::move(element));
+        }
+    }
+    out = std::move(items);
+}
+
+template <class T, class C, class A>
+void decodeValue(std::map<std::string, T, C, A> &out, const CJson &json, bool as_request)
+{
+    if (!json.isObject()) {
+        throw ModelException("Value is not an object", std::string(), std::string(), ProblemCause::INVALID_MSG_FORMAT);
+    }
+
+    std::map<std::string, T, C, A> items;
+    for (auto var : json) {
+        T element{};
+        try {
+            decodeValue(element, var, as_request);
+        } catch (ModelException &ex) {
+            throw ModelException(ex.what(), ex.classname, FieldCodec::joinParameter(var.key(), ex.parameter), ex.cause);
+        }
+        items.insert(std::make_pair(std::string(var.key()), std::move(element)));
+    }
+    out = std::move(items);
+}
+
+template <class T>
+CJson encodeValue(const T &value, bool as_request)
+{
+    return CJson::wrap(value, as_request);
+}
+
+template <class T>
+CJson encodeValue(const std::shared_ptr<T> &value, bool as_request)
+{
+    return value?value->toJSON(as_request):CJson::Null;
+}
+
+template <class T>
+CJson encodeValue(const std::optional<T> &value, bool as_request)
+{
+    return value.has_value()?encodeValue(value.value(), as_request):CJson::Null;
+}
+
+template <class T, class A>
+CJson encodeValue(const std::list<T, A> &value, bool as_request)
+{
+    CJson array = CJson::newArray();
+    for (const auto &item : value) {
+        CJson item_json(encodeValue(item, as_request));
+        if (!item_json.isNull()) array.append(std::move(item_json));
+    }
+    return array;
+}
+
+template <class T, class C, class A>
+CJson encodeValue(const std::map<std::string, T, C, A> &value, bool as_request)
+{
+    CJson object = CJson::newObject();
+    for (const auto &item : value) {
+        if constexpr (requires { item.second.has_value(); }) {
+            if (!item.second.has_value()) continue;
+        }
+        object.set(item.first, encodeValue(item.second, as_request));
+    }
+    return object;
+}
+
+template <class T>
+struct FieldKind {
+    static constexpr FieldOps::Kind value = FieldOps::SCALAR;
+};
+
+template <class T>
+struct FieldKind<std::optional<T> > : FieldKind<T> {};
+
+template <class T, class A>
+struct FieldKind<std::list<T, A> > {
+    static constexpr FieldOps::Kind value = FieldOps::ARRAY;
+};
+
+template <class T, class C, class A>
+struct FieldKind<std::map<std::string, T, C, A> > {
+    static constexpr FieldOps::Kind value = FieldOps::MAP;
+};
+
+template <class T>
+struct FieldOpsFor {
+    static void decode(void *member, const CJson &json, bool as_request) {
+        decodeValue(*static_cast<T*>(member), json, as_request);
+    };
+    static CJson encode(const void *member, bool as_request) {
+        return encodeValue(*static_cast<const T*>(member), as_request);
+    };
+    static bool isSet(const void *member) {
+        if constexpr (requires (const T &value) { value.has_value(); }) {
+            return static_cast<const T*>(member)->has_value();
+        } else {
+            return true;
+        }
+    };
+    static bool equals(const void *a, const void *b) {
+        return valueEquals(*static_cast<const T*>(a), *static_cast<const T*>(b));
+    };
+    static std::size_t hash(const void *member) {
+        return hashValue(*static_cast<const T*>(member));
+    };
+};
+
+/* The FieldOps for members of type T, shared by all fields of that type */
+template <class T>
+inline constexpr FieldOps fieldOps = {
+    FieldKind<T>::value,
+    &FieldOpsFor<T>::decode,
+    &FieldOpsFor<T>::encode,
+    &FieldOpsFor<T>::isSet,
+    &FieldOpsFor<T>::equals,
+    &FieldOpsFor<T>::hash
+};
+
+} /* end namespace */
+
+/* vim:ts=8:sts=4:sw=4:expandtab:
+ */
+
+#endif /* _OPENAPI_FIELD_CODEC_HH_ */
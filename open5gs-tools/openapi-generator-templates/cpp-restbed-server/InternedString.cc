@@ -0,0 +1,114 @@
+/**************************************************************************
+ * InternedString.cc : Shared immutable string values
+ **************************************************************************
+ * The pool is split into shards by hash to keep lock contention down when
+ * several threads are decoding at once. Each pool entry is a weak reference
+ * keyed by a view of the pooled string itself, the deleter of the shared
+ * string removes its own entry, checking that the entry has not already
+ * been replaced by a fresh copy of the same value.
+ **************************************************************************
+ * License: 5G-MAG Public License (v1.0)
+ * Author: David Waring
+ * Copyright: (C)2025 British Broadcasting Corporation
+ *
+ * For full license terms please see the LICENSE file distributed with this
+ * program. If this file is missing then the license can be retrieved from
+ * https://drive.google.com/file/d/1cinCiA778IErENZ3JN52VFW-1ffHpx7Z/view
+ */
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include "CJson.hh"
+#include "ModelException.hh"
+#include "ProblemCause.hh"
+#include "InternedString.hh"
+
+namespace fiveg_mag_reftools {
+
+namespace {
+
+constexpr std::size_t NumShards = 16;
+
+struct PoolShard {
+    std::mutex lock;
+    std::unordered_map<std::string_view, std::weak_ptr<const std::string> > entries;
+};
+
+/* Never destroyed so that InternedStrings in static objects can still be
+ * released during program exit */
+PoolShard *pool()
+{
+    static PoolShard *shards = new PoolShard[NumShards];
+    return shards;
+}
+
+PoolShard &shardFor(std::string_view value)
+{
+    return pool()[std::hash<std::string_view>()(value) % NumShards];
+}
+
+struct PoolDeleter {
+    void operator()(const std::string *value) const {
+        {
+            PoolShard &shard = shardFor(*value);
+            std::lock_guard<std::mutex> guard(shard.lock);
+            auto it = shard.entries.find(std::string_view(*value));
+            if (it != shard.entries.end() && it->first.data() == value->data()) shard.entries.erase(it);
+        }
+        delete value;
+    };
+};
+
+} /* end anonymous namespace */
+
+const std::string InternedString::s_empty;
+
+InternedString::InternedString(const CJson &json)
+    :m_value()
+{
+    const char *value = json.stringValue();
+    if (!value) throw ModelException("Attempt to access non-string value as string", "CJson", std::string(), ProblemCause::INVALID_MSG_FORMAT);
+    m_value = intern(std::string_view(value));
+}
+
+std::shared_ptr<const std::string> InternedString::intern(std::string_view value)
+{
+    /* the empty string is represented by a null reference */
+    if (value.empty()) return nullptr;
+
+    PoolShard &shard = shardFor(value);
+    std::lock_guard<std::mutex> guard(shard.lock);
+
+    auto it = shard.entries.find(value);
+    if (it != shard.entries.end()) {
+        std::shared_ptr<const std::string> existing(it->second.lock());
+        if (existing) return existing;
+        /* entry is expiring, its deleter will see that it has been replaced */
+        shard.entries.erase(it);
+    }
+
+    std::shared_ptr<const std::string> entry(new std::string(value), PoolDeleter());
+    shard.entries.emplace(std::string_view(*entry), entry);
+    return entry;
+}
+
+std::size_t InternedString::poolSize()
+{
+    std::size_t size = 0;
+    for (std::size_t i = 0; i < NumShards; i++) {
+        std::lock_guard<std::mutex> guard(pool()[i].lock);
+        size += pool()[i].entries.size();
+    }
+    return size;
+}
+
+} /* end namespace */
+
+/* vim:ts=8:sts=4:sw=4:expandtab:
+ */
@@ -0,0 +1,95 @@
+/**************************************************************************
+ * InternedString.hh : Shared immutable string values
+ **************************************************************************
+ * An InternedString refers to a single immutable copy of its value held in
+ * a process wide pool, so all InternedStrings with the same value share the
+ * same storage and can be compared by pointer. Entries are removed from the
+ * pool when the last InternedString referring to them goes away.
+ *
+ * Model properties are generated using this type instead of std::string
+ * when the string schema has the "x-5gmag-intern: true" vendor extension.
+ * When the "internEnumStrings" generator option is set, the string values
+ * held by anyOf(enum, string) fallback enums are interned as well.
+ **************************************************************************
+ * License: 5G-MAG Public License (v1.0)
+ * Author: David Waring
+ * Copyright: (C)2025 British Broadcasting Corporation
+ *
+ * For full license terms please see the LICENSE file distributed with this
+ * program. If this file is missing then the license can be retrieved from
+ * https://drive.google.com/file/d/1cinCiA778IErENZ3JN52VFW-1ffHpx7Z/view
+ */
+
+#ifndef _OPENAPI_INTERNED_STRING_HH_
+#define _OPENAPI_INTERNED_STRING_HH_
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+namespace fiveg_mag_reftools {
+
+class CJson;
+
+class InternedString {
+public:
+    typedef std::string::value_type value_type;
+    typedef std::string::size_type size_type;
+
+    InternedString() :m_value() {};
+    InternedString(const std::string &value) :m_value(intern(value)) {};
+    InternedString(std::string_view value) :m_value(intern(value)) {};
+    InternedString(const char *value) :m_value(value?intern(std::string_view(value)):nullptr) {};
+    explicit InternedString(const CJson &json);
+    InternedString(const InternedString &other) = default;
+    InternedString(InternedString &&other) = default;
+
+    InternedString &operator=(const InternedString &other) = default;
+    InternedString &operator=(InternedString &&other) = default;
+
+    const std::string &str() const { return m_value?*m_value:s_empty; };
+    const char *c_str() const { return str().c_str(); };
+    size_type size() const { return str().size(); };
+    bool empty() const { return !m_value; };
+
+    operator const std::string &() const { return str(); };
+    operator std::string_view() const { return std::string_view(str()); };
+
+    /* Interned values are unique so equality is identity */
+    bool operator==(const InternedString &other) const { return m_value == other.m_value; };
+    bool operator!=(const InternedString &other) const { return m_value != other.m_value; };
+    bool operator==(const std::string &other) const { return str() == other; };
+    bool operator!=(const std::string &other) const { return str() != other; };
+    bool operator==(const char *other) const { return str() == other; };
+    bool operator!=(const char *other) const { return str() != other; };
+    bool operator<(const InternedString &other) const { return m_value != other.m_value && str() < other.str(); };
+
+    std::size_t hash() const { return std::hash<const std::string*>()(m_value.get()); };
+
+    /* Number of distinct values currently held in the pool */
+    static std::size_t poolSize();
+
+private:
+    static std::shared_ptr<const std::string> intern(std::string_view value);
+
+    static const std::string s_empty;
+
+    std::shared_ptr<const std::string> m_value;
+};
+
+inline std::ostream &operator<<(std::ostream &os, const InternedString &str) { return os << str.str(); }
+
+} /* end namespace */
+
+template <>
+struct std::hash<fiveg_mag_reftools::InternedString> {
+    std::size_t operator()(const fiveg_mag_reftools::InternedString &str) const noexcept { return str.hash(); };
+};
+
+/* vim:ts=8:sts=4:sw=4:expandtab:
+ */
+
+#endif /* _OPENAPI_INTERNED_STRING_HH_ */
@@ -0,0 +1,90 @@
+/**************************************************************************
+ * JsonPointer.cc : Pre-parsed RFC 6901 JSON Pointer
+ **************************************************************************
+ * License: 5G-MAG Public License (v1.0)
+ * Author: David Waring
+ * Copyright: (C)2025 British Broadcasting Corporation
+ *
+ * For full license terms please see the LICENSE file distributed with this
+ * program. If this file is missing then the license can be retrieved from
+ * https://drive.google.com/file/d/1cinCiA778IErENZ3JN52VFW-1ffHpx7Z/view
+ */
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "ModelException.hh"
+#include "ProblemCause.hh"
+#include "JsonPointer.hh"
+
+namespace fiveg_mag_reftools {
+
+JsonPointer::JsonPointer(std::string_view pointer)
+    :m_tokens()
+    ,m_offset(0)
+{
+    if (pointer.empty()) return;
+
+    if (pointer.front() != '/') {
+        throw ModelException(std::string("Runtime Error: JSON Pointer must start with \"/\": ") + std::string(pointer), "JsonPointer", "path", ProblemCause::INVALID_MSG_FORMAT);
+    }
+
+    std::vector<std::string> tokens;
+    std::size_t start = 1;
+    while (true) {
+        std::size_t end = pointer.find('/', start);
+        std::string_view raw(pointer.substr(start, end == std::string_view::npos ? std::string_view::npos : end - start));
+        std::string &token = tokens.emplace_back();
+        token.reserve(raw.size());
+        for (std::size_t i = 0; i < raw.size(); i++) {
+            if (raw[i] != '~') {
+                token.push_back(raw[i]);
+            } else if (i + 1 < raw.size() && raw[i+1] == '0') {
+                token.push_back('~');
+                i++;
+            } else if (i + 1 < raw.size() && raw[i+1] == '1') {
+                token.push_back('/');
+                i++;
+            } else {
+                throw ModelException(std::string("Runtime Error: Invalid escape in JSON Pointer: ") + std::string(pointer), "JsonPointer", "path", ProblemCause::INVALID_MSG_FORMAT);
+            }
+        }
+        if (end == std::string_view::npos) break;
+        start = end + 1;
+    }
+
+    m_tokens = std::make_shared<const std::vector<std::string> >(std::move(tokens));
+}
+
+std::string JsonPointer::str() const
+{
+    std::string ret;
+    for (std::size_t i = m_offset; m_tokens && i < m_tokens->size(); i++) {
+        ret.push_back('/');
+        ret.append(escape((*m_tokens)[i]));
+    }
+    return ret;
+}
+
+std::string JsonPointer::escape(std::string_view token)
+{
+    std::string ret;
+    ret.reserve(token.size());
+    for (auto c : token) {
+        if (c == '~') {
+            ret.append("~0");
+        } else if (c == '/') {
+            ret.append("~1");
+        } else {
+            ret.push_back(c);
+        }
+    }
+    return ret;
+}
+
+} /* end namespace */
+
+/* vim:ts=8:sts=4:sw=4:expandtab:
+ */
@@ -0,0 +1,79 @@
+/**************************************************************************
+ * JsonPointer.hh : Pre-parsed RFC 6901 JSON Pointer
+ **************************************************************************
+ * A JSON Pointer string is split into its reference tokens, with the "~1"
+ * and "~0" escapes already undone, once when it is constructed. The
+ * resulting JsonPointer is a view over the remaining tokens: tail() drops
+ * the first token without copying, so recursing down a model tree while
+ * applying a JSON Patch does not re-scan or copy the path at each level.
+ *
+ * References returned by front() remain valid while any JsonPointer
+ * sharing the same parsed path still exists.
+ **************************************************************************
+ * License: 5G-MAG Public License (v1.0)
+ * Author: David Waring
+ * Copyright: (C)2025 British Broadcasting Corporation
+ *
+ * For full license terms please see the LICENSE file distributed with this
+ * program. If this file is missing then the license can be retrieved from
+ * https://drive.google.com/file/d/1cinCiA778IErENZ3JN52VFW-1ffHpx7Z/view
+ */
+
+#ifndef _OPENAPI_JSON_POINTER_HH_
+#define _OPENAPI_JSON_POINTER_HH_
+
+#include <cstddef>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace fiveg_mag_reftools {
+
+class JsonPointer {
+public:
+    /* The empty pointer, referring to the whole document */
+    JsonPointer() :m_tokens() ,m_offset(0) {};
+    /* Parse a JSON Pointer, throws ModelException if it is not valid */
+    explicit JsonPointer(std::string_view pointer);
+    JsonPointer(const JsonPointer &other) = default;
+    JsonPointer(JsonPointer &&other) = default;
+
+    JsonPointer &operator=(const JsonPointer &other) = default;
+    JsonPointer &operator=(JsonPointer &&other) = default;
+
+    /* true if there are no more reference tokens */
+    bool empty() const { return size() == 0; };
+    std::size_t size() const { return m_tokens?(m_tokens->size() - m_offset):0; };
+
+    /* The first reference token, unescaped */
+    const std::string &front() const { return (*m_tokens)[m_offset]; };
+
+    /* The pointer to the remainder after the first reference token */
+    JsonPointer tail() const { return JsonPointer(m_tokens, m_offset + 1); };
+
+    /* The remaining pointer as a JSON Pointer string */
+    std::string str() const;
+
+    /* Escape a single reference token ("~" => "~0", "/" => "~1") */
+    static std::string escape(std::string_view token);
+
+private:
+    JsonPointer(const std::shared_ptr<const std::vector<std::string> > &tokens, std::size_t offset)
+        :m_tokens(tokens)
+        ,m_offset(offset)
+        {};
+
+    std::shared_ptr<const std::vector<std::string> > m_tokens;
+    std::size_t m_offset;
+};
+
+inline std::ostream &operator<<(std::ostream &os, const JsonPointer &ptr) { return os << ptr.str(); }
+
+} /* end namespace */
+
+/* vim:ts=8:sts=4:sw=4:expandtab:
+ */
+
+#endif /* _OPENAPI_JSON_POINTER_HH_ */
@@ -0,0 +1,210 @@
+/**************************************************************************
+ * ModelDiff.hh : JSON Patch generation between model values
+ **************************************************************************
+ * Generic helpers used by the generated diff() methods to build an RFC 6902
+ * JSON Patch which, when applied with applyJSONPatch(), turns one model
+ * value into another.
+ *
+ * Child models which are the same object (e.g. shared between an original
+ * and the result of newWithJSONPatches()), or which have the same hash()
+ * and compare equal, are skipped without being visited. Other child objects
+ * are descended into so that only the fields that changed are emitted. Maps
+ * are compared key by key, lists are replaced as a whole when any item
+ * differs.
+ **************************************************************************
+ * License: 5G-MAG Public License (v1.0)
+ * Author: David Waring
+ * Copyright: (C)2025 British Broadcasting Corporation
+ *
+ * For full license terms please see the LICENSE file distributed with this
+ * program. If this file is missing then the license can be retrieved from
+ * https://drive.google.com/file/d/1cinCiA778IErENZ3JN52VFW-1ffHpx7Z/view
+ */
+
+#ifndef _OPENAPI_MODEL_DIFF_HH_
+#define _OPENAPI_MODEL_DIFF_HH_
+
+#include <concepts>
+#include <cstddef>
+#include <list>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+
+#include "CJson.hh"
+#include "JsonPointer.hh"
+
+namespace fiveg_mag_reftools {
+
+/* Append a single JSON Patch operation to the patches array */
+inline void appendPatchOp(CJson &patches, const char *op, const std::string &path, const CJson *value = nullptr)
+{
+    CJson patch(CJson::newObject());
+    patch.set("op", CJson::newString(op));
+    patch.set("path", CJson::newString(path));
+    if (value) patch.set("value", *value);
+    patches.append(std::move(patch));
+}
+
+/* Encode a value as it would appear in a request */
+template <class T> CJson diffEncode(const T &value);
+template <class T> CJson diffEncode(const std::shared_ptr<T> &value);
+template <class T> CJson diffEncode(const std::optional<T> &value);
+template <class T, class A> CJson diffEncode(const std::list<T, A> &value);
+template <class K, class T, class C, class A> CJson diffEncode(const std::map<K, T, C, A> &value);
+
+template <class T>
+CJson diffEncode(const T &value)
+{
+    return CJson::wrap(value, true);
+}
+
+template <class T>
+CJson diffEncode(const std::shared_ptr<T> &value)
+{
+    return value?value->toJSON(true):CJson::Null;
+}
+
+template <class T>
+CJson diffEncode(const std::optional<T> &value)
+{
+    return value.has_value()?diffEncode(value.value()):CJson::Null;
+}
+
+template <class T, class A>
+CJson diffEncode(const std::list<T, A> &value)
+{
+    CJson array(CJson::newArray());
+    for (const auto &item : value) array.append(diffEncode(item));
+    return array;
+}
+
+template <class K, class T, class C, class A>
+CJson diffEncode(const std::map<K, T, C, A> &value)
+{
+    CJson object(CJson::newObject());
+    for (const auto &[key, item] : value) object.set(key, diffEncode(item));
+    return object;
+}
+
+/* Compare values, comparing child models by content rather than by pointer */
+template <class T> bool valueEquals(const T &a, const T &b);
+template <class T> bool valueEquals(const std::shared_ptr<T> &a, const std::shared_ptr<T> &b);
+template <class T> bool valueEquals(const std::optional<T> &a, const std::optional<T> &b);
+template <class T, class A> bool valueEquals(const std::list<T, A> &a, const std::list<T, A> &b);
+template <class K, class T, class C, class A> bool valueEquals(const std::map<K, T, C, A> &a, const std::map<K, T, C, A> &b);
+
+template <class T>
+bool valueEquals(const T &a, const T &b)
+{
+    return a == b;
+}
+
+template <class T>
+bool valueEquals(const std::shared_ptr<T> &a, const std::shared_ptr<T> &b)
+{
+    if (a == b) return true;
+    if (!a || !b) return false;
+    return *a == *b;
+}
+
+template <class T>
+bool valueEquals(const std::optional<T> &a, const std::optional<T> &b)
+{
+    if (a.has_value() != b.has_value()) return false;
+    return !a.has_value() || valueEquals(a.value(), b.value());
+}
+
+template <class T, class A>
+bool valueEquals(const std::list<T, A> &a, const std::list<T, A> &b)
+{
+    if (a.size() != b.size()) return false;
+    for (auto a_it = a.begin(), b_it = b.begin(); a_it != a.end(); ++a_it, ++b_it) {
+        if (!valueEquals(*a_it, *b_it)) return false;
+    }
+    return true;
+}
+
+template <class K, class T, class C, class A>
+bool valueEquals(const std::map<K, T, C, A> &a, const std::map<K, T, C, A> &b)
+{
+    if (a.size() != b.size()) return false;
+    for (auto a_it = a.begin(), b_it = b.begin(); a_it != a.end(); ++a_it, ++b_it) {
+        if (a_it->first != b_it->first || !valueEquals(a_it->second, b_it->second)) return false;
+    }
+    return true;
+}
+
+/* Append the operations which turn a into b, where path refers to a */
+template <class T> void diffValue(const T &a, const T &b, const std::string &path, CJson &patches);
+template <class T> void diffValue(const std::shared_ptr<T> &a, const std::shared_ptr<T> &b, const std::string &path, CJson &patches);
+template <class T> void diffValue(const std::optional<T> &a, const std::optional<T> &b, const std::string &path, CJson &patches);
+template <class K, class T, class C, class A> void diffValue(const std::map<K, T, C, A> &a, const std::map<K, T, C, A> &b, const std::string &path, CJson &patches);
+
+template <class T>
+void diffValue(const T &a, const T &b, const std::string &path, CJson &patches)
+{
+    if (!valueEquals(a, b)) {
+        CJson value(diffEncode(b));
+        appendPatchOp(patches, "replace", path, &value);
+    }
+}
+
+template <class T>
+void diffValue(const std::shared_ptr<T> &a, const std::shared_ptr<T> &b, const std::string &path, CJson &patches)
+{
+    if (a == b) return;
+    if (a && b) {
+        /* Equal hashes are almost always equal content, confirmed with
+         * operator== before skipping the child without visiting its fields */
+        if constexpr (requires { { a->hash() } -> std::convertible_to<std::size_t>; }) {
+            if (a->hash() == b->hash() && *a == *b) return;
+        }
+        if constexpr (requires { a->diff(*b, path, patches); }) {
+            a->diff(*b, path, patches);
+            return;
+        } else {
+            if (*a == *b) return;
+        }
+    }
+    CJson value(diffEncode(b));
+    appendPatchOp(patches, "replace", path, &value);
+}
+
+template <class T>
+void diffValue(const std::optional<T> &a, const std::optional<T> &b, const std::string &path, CJson &patches)
+{
+    if (!b.has_value()) {
+        if (a.has_value()) appendPatchOp(patches, "remove", path);
+    } else if (!a.has_value()) {
+        CJson value(diffEncode(b.value()));
+        appendPatchOp(patches, "add", path, &value);
+    } else {
+        diffValue(a.value(), b.value(), path, patches);
+    }
+}
+
+template <class K, class T, class C, class A>
+void diffValue(const std::map<K, T, C, A> &a, const std::map<K, T, C, A> &b, const std::string &path, CJson &patches)
+{
+    for (const auto &[key, item] : a) {
+        if (!b.contains(key)) appendPatchOp(patches, "remove", path + "/" + JsonPointer::escape(key));
+    }
+    for (const auto &[key, item] : b) {
+        auto it = a.find(key);
+        if (it == a.end()) {
+            CJson value(diffEncode(item));
+            appendPatchOp(patches, "add", path + "/" + JsonPointer::escape(key), &value);
+        } else {
+            diffValue(it->second, item, path + "/" + JsonPointer::escape(key), patches);
+        }
+    }
+}
+
+} /* end namespace */
+
+/* vim:ts=8:sts=4:sw=4:expandtab:
+ */
+
+#endif /* _OPENAPI_MODEL_DIFF_HH_ */
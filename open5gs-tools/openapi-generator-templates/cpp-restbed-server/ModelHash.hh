@@ -0,0 +1,100 @@
+/**************************************************************************
+ * ModelHash.hh : Structural hashing of model values
+ **************************************************************************
+ * Generic helpers used by the generated computeHash() methods to hash the
+ * content of a model, field by field, in a form that is consistent with
+ * operator== (i.e. values which compare equal have the same hash).
+ *
+ * Child models are hashed by content via their (cached) hash(), absent
+ * optional values hash differently to present but empty ones, and lists
+ * and maps are hashed in order (std::map is already ordered by key).
+ **************************************************************************
+ * License: 5G-MAG Public License (v1.0)
+ * Author: David Waring
+ * Copyright: (C)2025 British Broadcasting Corporation
+ *
+ * For full license terms please see the LICENSE file distributed with this
+ * program. If this file is missing then the license can be retrieved from
+ * https://drive.google.com/file/d/1cinCiA778IErENZ3JN52VFW-1ffHpx7Z/view
+ */
+
+#ifndef _OPENAPI_MODEL_HASH_HH_
+#define _OPENAPI_MODEL_HASH_HH_
+
+#include <concepts>
+#include <cstddef>
+#include <functional>
+#include <list>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string_view>
+
+namespace fiveg_mag_reftools {
+
+/* Mix the hash h into seed */
+inline void hashCombine(std::size_t &seed, std::size_t h)
+{
+    seed ^= h + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2);
+}
+
+template <class T> std::size_t hashValue(const T &value);
+template <class T> std::size_t hashValue(const std::shared_ptr<T> &value);
+template <class T> std::size_t hashValue(const std::optional<T> &value);
+template <class T, class A> std::size_t hashValue(const std::list<T, A> &value);
+template <class K, class T, class C, class A> std::size_t hashValue(const std::map<K, T, C, A> &value);
+
+template <class T>
+std::size_t hashValue(const T &value)
+{
+    if constexpr (requires { { value.hash() } -> std::convertible_to<std::size_t>; }) {
+        /* models, InternedString, DateTime, Date */
+        return value.hash();
+    } else if constexpr (requires { value.data(); value.size(); }) {
+        /* strings, byte arrays and borrowed strings, by content */
+        return std::hash<std::string_view>()(std::string_view(reinterpret_cast<const char*>(value.data()), value.size() * sizeof(*value.data())));
+    } else {
+        return std::hash<T>()(value);
+    }
+}
+
+template <class T>
+std::size_t hashValue(const std::shared_ptr<T> &value)
+{
+    return value?hashValue(*value):0;
+}
+
+template <class T>
+std::size_t hashValue(const std::optional<T> &value)
+{
+    if (!value.has_value()) return 0;
+    std::size_t seed = 1;
+    hashCombine(seed, hashValue(value.value()));
+    return seed;
+}
+
+template <class T, class A>
+std::size_t hashValue(const std::list<T, A> &value)
+{
+    std::size_t seed = value.size();
+    for (const auto &item : value) hashCombine(seed, hashValue(item));
+    return seed;
+}
+
+template <class K, class T, class C, class A>
+std::size_t hashValue(const std::map<K, T, C, A> &value)
+{
+    std::size_t seed = value.size();
+    for (const auto &[key, item] : value) {
+        hashCombine(seed, hashValue(key));
+        hashCombine(seed, hashValue(item));
+    }
+    return seed;
+}
+
+} /* end namespace */
+
+/* vim:ts=8:sts=4:sw=4:expandtab:
+ */
+
+#endif /* _OPENAPI_MODEL_HASH_HH_ */
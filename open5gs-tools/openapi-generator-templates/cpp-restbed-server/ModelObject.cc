@@ -0,0 +1,87 @@
+/**************************************************************************
+ * ModelObject.cc : ModelObject model base class/interface
+ **************************************************************************
+ * License: 5G-MAG Public License (v1.0)
+ * Author: David Waring
+ * Copyright: (C)2025 British Broadcasting Corporation
+ *
+ * For full license terms please see the LICENSE file distributed with this
+ * program. If this file is missing then the license can be retrieved from
+ * https://drive.google.com/file/d/1cinCiA778IErENZ3JN52VFW-1ffHpx7Z/view
+ */
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+
+#include "CJson.hh"
+#include "ModelObject.hh"
+
+namespace fiveg_mag_reftools {
+
+static std::atomic<std::uint64_t> g_revision(0);
+
+std::uint64_t ModelObject::nextRevision()
+{
+    return g_revision.fetch_add(1, std::memory_order_relaxed) + 1;
+}
+
+std::shared_ptr<const ModelObject::Serialised> ModelObject::serialised(bool as_request) const
+{
+    auto &slot = m_serialised[as_request?1:0];
+    std::uint64_t revision = subtreeRevision();
+
+    std::shared_ptr<const Serialised> cached(slot.load(std::memory_order_acquire));
+    if (cached && cached->revision == revision) return cached;
+
+    std::shared_ptr<Serialised> fresh(std::make_shared<Serialised>());
+    fresh->revision = revision;
+    fresh->json = toJSON(as_request).serialise();
+    fresh->hash = 0xcbf29ce484222325ULL;
+    for (unsigned char c : fresh->json) {
+        fresh->hash = (fresh->hash ^ c) * 0x100000001b3ULL;
+    }
+
+    slot.store(fresh, std::memory_order_release);
+    return fresh;
+}
+
+std::size_t ModelObject::hash() const
+{
+    std::uint64_t revision = subtreeRevision();
+    if (m_hashRevision.load(std::memory_order_acquire) == revision) return m_hash.load(std::memory_order_relaxed);
+
+    std::size_t ret = computeHash();
+    m_hash.store(ret, std::memory_order_relaxed);
+    m_hashRevision.store(revision, std::memory_order_release);
+    return ret;
+}
+
+std::size_t ModelObject::computeHash() const
+{
+    return toJSON(false).hash();
+}
+
+bool ModelObject::cachedHashesDiffer(const ModelObject &other) const
+{
+    std::uint64_t revision = m_hashRevision.load(std::memory_order_acquire);
+    std::uint64_t other_revision = other.m_hashRevision.load(std::memory_order_acquire);
+    if (revision == 0 || other_revision == 0) return false;
+    if (revision != subtreeRevision() || other_revision != other.subtreeRevision()) return false;
+    return m_hash.load(std::memory_order_relaxed) != other.m_hash.load(std::memory_order_relaxed);
+}
+
+std::string ModelObject::Serialised::etag() const
+{
+    char buf[19];
+    std::snprintf(buf, sizeof(buf), "\"%016llx\"", static_cast<unsigned long long>(hash));
+    return std::string(buf);
+}
+
+} /* end namespace */
+
+/* vim:ts=8:sts=4:sw=4:expandtab:
+ */
@@ -16,7 +16,16 @@
 #ifndef _OPENAPI_MODEL_OBJECT_HH_
 #define _OPENAPI_MODEL_OBJECT_HH_
 
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <map>
+#include <memory>
+#include <optional>
 #include <string>
+#include <type_traits>
 #include "CJson.hh"
 #include "ModelObject.hh"
 #include "ModelException.hh"
@@ -26,9 +35,29 @@ namespace fiveg_mag_reftools {
 
 class ModelObject {
 public:
-    ModelObject() {};
-    ModelObject(const ModelObject &other) {};
-    ModelObject(ModelObject &&other) {};
+    /* A serialised form of a model, see serialised() */
+    struct Serialised {
+        std::uint64_t revision; /* subtreeRevision() of the model when serialised */
+        std::string json;
+        std::uint64_t hash;     /* FNV-1a hash of json */
+
+        /* Strong entity tag (RFC 9110), including the quotes */
+        std::string etag() const;
+    };
+
+    ModelObject() :m_revision(nextRevision()) ,m_serialised() ,m_hashRevision(0) ,m_hash(0) {};
+    ModelObject(const ModelObject &other)
+        :m_revision(other.m_revision)
+        ,m_serialised{other.m_serialised[0].load(), other.m_serialised[1].load()}
+        ,m_hashRevision(other.m_hashRevision.load())
+        ,m_hash(other.m_hash.load())
+        {};
+    ModelObject(ModelObject &&other)
+        :m_revision(other.m_revision)
+        ,m_serialised{other.m_serialised[0].load(), other.m_serialised[1].load()}
+        ,m_hashRevision(other.m_hashRevision.load())
+        ,m_hash(other.m_hash.load())
+        {};
 
     virtual ~ModelObject() {};
 
@@ -36,8 +65,122 @@ public:
     virtual void fromJSON(const CJson &json, bool as_request = false) = 0;
 
     virtual bool validate() const = 0;
+
+    /* Replace any values borrowed from a retained input document with
+     * owned copies (see BorrowedString.hh) */
+    virtual void detach() {};
+
+    /* Revision stamps are taken from a single increasing counter whenever
+     * an object is modified, so the latest stamp in a tree of models
+     * changes whenever anything in that tree is modified */
+    std::uint64_t revision() const { return m_revision; };
+    virtual std::uint64_t subtreeRevision() const { return m_revision; };
+
+    /* The serialised toJSON(as_request), reused until this object or one
+     * of its child models is modified. Safe to call from several threads
+     * as long as nothing is modifying the model. */
+    std::shared_ptr<const Serialised> serialised(bool as_request = false) const;
+    std::string etag(bool as_request = false) const { return serialised(as_request)->etag(); };
+
+    /* Structural hash of the model content, consistent with operator==.
+     * Cached in the same way as serialised(). */
+    std::size_t hash() const;
+
+protected:
+    /* Called by every method which modifies the object */
+    void touch() { m_revision = nextRevision(); };
+
+    /* Calculate hash(), generated models hash their fields in order */
+    virtual std::size_t computeHash() const;
+
+    /* true if both objects have a cached hash() and they differ, so
+     * operator== can return early without comparing the fields */
+    bool cachedHashesDiffer(const ModelObject &other) const;
+
+private:
+    static std::uint64_t nextRevision();
+
+    std::uint64_t m_revision;
+    mutable std::atomic<std::shared_ptr<const Serialised> > m_serialised[2];
+    mutable std::atomic<std::uint64_t> m_hashRevision;
+    mutable std::atomic<std::size_t> m_hash;
 };
 
+/* Latest revision stamp of the models within a field value, 0 if there are
+ * none */
+template <class T> std::uint64_t subtreeRevisionOf(const T &value);
+template <class T> std::uint64_t subtreeRevisionOf(const std::shared_ptr<T> &value);
+template <class T> std::uint64_t subtreeRevisionOf(const std::optional<T> &value);
+template <class T, class A> std::uint64_t subtreeRevisionOf(const std::list<T, A> &value);
+template <class K, class T, class C, class A> std::uint64_t subtreeRevisionOf(const std::map<K, T, C, A> &value);
+
+template <class T>
+std::uint64_t subtreeRevisionOf(const T &value)
+{
+    if constexpr (std::is_base_of_v<ModelObject, T>) {
+        return value.subtreeRevision();
+    } else {
+        return 0;
+    }
+}
+
+template <class T>
+std::uint64_t subtreeRevisionOf(const std::shared_ptr<T> &value)
+{
+    return value?subtreeRevisionOf(*value):0;
+}
+
+template <class T>
+std::uint64_t subtreeRevisionOf(const std::optional<T> &value)
+{
+    return value.has_value()?subtreeRevisionOf(value.value()):0;
+}
+
+template <class T, class A>
+std::uint64_t subtreeRevisionOf(const std::list<T, A> &value)
+{
+    std::uint64_t ret = 0;
+    for (const auto &item : value) ret = std::max(ret, subtreeRevisionOf(item));
+    return ret;
+}
+
+template <class K, class T, class C, class A>
+std::uint64_t subtreeRevisionOf(const std::map<K, T, C, A> &value)
+{
+    std::uint64_t ret = 0;
+    for (const auto &[key, item] : value) ret = std::max(ret, subtreeRevisionOf(item));
+    return ret;
+}
+
+/* Model children are held by shared_ptr and are shared between copies of
+ * their parent (e.g. the result of newWithJSONPatches() and its original),
+ * so a child must not be modified in place while another copy refers to it.
+ * Make ptr the only reference to its object, cloning it if necessary.
+ */
+template <class T>
+void copyOnWrite(std::shared_ptr<T> &ptr)
+{
+    if (ptr && ptr.use_count() > 1) ptr.reset(new T(*ptr));
+}
+
+/* Apply an RFC 7396 JSON Merge Patch to a child model. Where the child
+ * exists and can be merged into (an object model and an object patch) only
+ * the members present in the patch are changed, otherwise the patch value
+ * replaces the child.
+ */
+template <class T>
+void mergePatchChild(std::shared_ptr<T> &ptr, const CJson &patch)
+{
+    if constexpr (requires { ptr->applyMergePatch(patch); }) {
+        if (ptr && patch.isObject()) {
+            copyOnWrite(ptr);
+            ptr->applyMergePatch(patch);
+            return;
+        }
+    }
+    ptr.reset(new T(patch, true));
+}
+
 } /* end namespace */
 
 /* vim:ts=8:sts=4:sw=4:expandtab:
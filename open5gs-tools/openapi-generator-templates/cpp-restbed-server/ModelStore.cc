@@ -0,0 +1,182 @@
+/**************************************************************************
+ * ModelStore.cc : Versioned store of immutable model snapshots
+ **************************************************************************
+ * Epoch based reclamation: each reading thread publishes the global epoch
+ * it entered at while it holds a Guard (0 when it holds none). Retiring an
+ * object stamps it with the current epoch and advances the global epoch,
+ * the object is then released once every reading thread is either idle or
+ * entered at a later epoch, as such a reader loaded the store pointer after
+ * the object had been replaced.
+ *
+ * So that the last object retired after a burst of updates is not kept
+ * until the next retire() or reclaim(), a reader leaving its outermost
+ * Guard reclaims if an object it may have been holding back, one retired
+ * at or after the epoch the reader entered at, is still waiting.
+ **************************************************************************
+ * License: 5G-MAG Public License (v1.0)
+ * Author: David Waring
+ * Copyright: (C)2025 British Broadcasting Corporation
+ *
+ * For full license terms please see the LICENSE file distributed with this
+ * program. If this file is missing then the license can be retrieved from
+ * https://drive.google.com/file/d/1cinCiA778IErENZ3JN52VFW-1ffHpx7Z/view
+ */
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <list>
+#include <mutex>
+
+#include "ModelStore.hh"
+
+namespace fiveg_mag_reftools {
+
+namespace {
+
+struct EpochThread {
+    ~EpochThread();
+
+    std::atomic<std::uint64_t> active;  /* epoch entered at, 0 if not reading */
+    unsigned int nesting;
+    bool registered;
+    EpochThread *next;
+    EpochThread *prev;
+};
+
+struct Retired {
+    void *ptr;
+    void (*deleter)(void*);
+    std::uint64_t epoch;
+};
+
+std::atomic<std::uint64_t> g_epoch(1);
+std::atomic<std::uint64_t> g_newestRetired(0);    /* epoch of the newest waiting entry, 0 if none */
+EpochThread *g_threads = nullptr;
+
+thread_local EpochThread t_epoch = {};
+
+/* The lock and the retired list are never destroyed, so that threads which
+ * exit, or static objects which retire models, during program exit do not
+ * use them after they have gone. Entries still retired at exit are left
+ * for the OS to reclaim. */
+std::mutex &epochLock()
+{
+    static auto *lock = new std::mutex;
+    return *lock;
+}
+
+std::list<Retired> &retiredList()
+{
+    static auto *retired = new std::list<Retired>;
+    return *retired;
+}
+
+EpochThread::~EpochThread()
+{
+    if (!registered) return;
+
+    std::lock_guard<std::mutex> lock(epochLock());
+    if (prev) {
+        prev->next = next;
+    } else {
+        g_threads = next;
+    }
+    if (next) next->prev = prev;
+}
+
+EpochThread &epochThread()
+{
+    if (!t_epoch.registered) {
+        std::lock_guard<std::mutex> lock(epochLock());
+        t_epoch.prev = nullptr;
+        t_epoch.next = g_threads;
+        if (g_threads) g_threads->prev = &t_epoch;
+        g_threads = &t_epoch;
+        t_epoch.registered = true;
+    }
+    return t_epoch;
+}
+
+/* Remove the entries which can be released from retiredList(), caller
+ * holds epochLock() */
+std::list<Retired> collectReclaimable()
+{
+    std::uint64_t oldest = std::numeric_limits<std::uint64_t>::max();
+    for (EpochThread *thread = g_threads; thread; thread = thread->next) {
+        std::uint64_t active = thread->active.load(std::memory_order_seq_cst);
+        if (active && active < oldest) oldest = active;
+    }
+
+    std::list<Retired> &retired = retiredList();
+    std::list<Retired> ret;
+    for (auto it = retired.begin(); it != retired.end(); ) {
+        auto current = it++;
+        if (current->epoch < oldest) ret.splice(ret.end(), retired, current);
+    }
+    /* entries are released oldest first, so any left include the newest */
+    if (retired.empty()) g_newestRetired.store(0, std::memory_order_seq_cst);
+    return ret;
+}
+
+} /* end anonymous namespace */
+
+ModelEpoch::Guard::Guard()
+{
+    EpochThread &thread = epochThread();
+    if (thread.nesting++ == 0) {
+        thread.active.store(g_epoch.load(std::memory_order_seq_cst), std::memory_order_seq_cst);
+    }
+}
+
+ModelEpoch::Guard::~Guard() noexcept
+{
+    EpochThread &thread = t_epoch;
+    if (--thread.nesting == 0) {
+        std::uint64_t entered = thread.active.load(std::memory_order_relaxed);
+        thread.active.store(0, std::memory_order_seq_cst);
+        /* Either this sees the newest retirement or the retire() call saw
+         * this thread idle and released it itself */
+        std::uint64_t newest = g_newestRetired.load(std::memory_order_seq_cst);
+        if (newest && newest >= entered) {
+            try {
+                reclaim();
+            } catch (...) {
+                /* left for the next retire() or reclaim() */
+            }
+        }
+    }
+}
+
+void ModelEpoch::retire(void *ptr, void (*deleter)(void*))
+{
+    std::list<Retired> reclaimable;
+    {
+        std::lock_guard<std::mutex> lock(epochLock());
+        std::uint64_t epoch = g_epoch.fetch_add(1, std::memory_order_seq_cst);
+        retiredList().push_back(Retired{ptr, deleter, epoch});
+        g_newestRetired.store(epoch, std::memory_order_seq_cst);
+        reclaimable = collectReclaimable();
+    }
+    /* deleters may release models, so run them without the lock held */
+    for (auto &entry : reclaimable) entry.deleter(entry.ptr);
+}
+
+std::size_t ModelEpoch::reclaim()
+{
+    std::list<Retired> reclaimable;
+    std::size_t waiting;
+    {
+        std::lock_guard<std::mutex> lock(epochLock());
+        reclaimable = collectReclaimable();
+        waiting = retiredList().size();
+    }
+    for (auto &entry : reclaimable) entry.deleter(entry.ptr);
+    return waiting;
+}
+
+} /* end namespace */
+
+/* vim:ts=8:sts=4:sw=4:expandtab:
+ */
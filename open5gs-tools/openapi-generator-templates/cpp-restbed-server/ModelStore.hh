@@ -0,0 +1,152 @@
+/**************************************************************************
+ * ModelStore.hh : Versioned store of immutable model snapshots
+ **************************************************************************
+ * A ModelStore holds the current version of a model as an immutable
+ * snapshot. Readers get the current snapshot without taking any locks and
+ * never see a partially modified model. Writers build a new version (e.g.
+ * with newWithJSONPatches(), which shares unmodified child models with the
+ * previous version) and publish it with a single atomic pointer swap.
+ *
+ * Replaced versions are reclaimed using epoch based reclamation: a reader
+ * holds a ModelEpoch::Guard while it uses a pointer returned by load(), and
+ * a replaced version is only released once every reader which might have
+ * loaded it has dropped its guard. Readers wanting to keep a version for
+ * longer (e.g. across an asynchronous response) should use snapshot().
+ *
+ *   ModelEpoch::Guard guard;
+ *   const ContentHostingConfiguration *chc = store.load(guard);
+ *
+ *   store.update([&](const ContentHostingConfiguration &current) {
+ *       return current.newWithJSONPatches(patches);
+ *   });
+ **************************************************************************
+ * License: 5G-MAG Public License (v1.0)
+ * Author: David Waring
+ * Copyright: (C)2025 British Broadcasting Corporation
+ *
+ * For full license terms please see the LICENSE file distributed with this
+ * program. If this file is missing then the license can be retrieved from
+ * https://drive.google.com/file/d/1cinCiA778IErENZ3JN52VFW-1ffHpx7Z/view
+ */
+
+#ifndef _OPENAPI_MODEL_STORE_HH_
+#define _OPENAPI_MODEL_STORE_HH_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+#include "ModelException.hh"
+#include "ProblemCause.hh"
+
+namespace fiveg_mag_reftools {
+
+class ModelEpoch {
+public:
+    /* Marks the current thread as reading from a ModelStore for the lifetime
+     * of the guard. Guards may be nested. The first Guard on a thread
+     * registers the thread, which takes a lock and so may throw
+     * std::system_error. Leaving the outermost Guard releases any retired
+     * versions which only this thread was still holding back. */
+    class Guard {
+    public:
+        Guard();
+        ~Guard() noexcept;
+
+    private:
+        Guard(const Guard&) = delete;
+        Guard &operator=(const Guard&) = delete;
+    };
+
+    /* Call deleter(ptr) once no reader can still be using ptr */
+    static void retire(void *ptr, void (*deleter)(void*));
+
+    /* Release retired objects which no reader can still be using, returns
+     * the number still waiting */
+    static std::size_t reclaim();
+
+private:
+    ModelEpoch() = delete;
+};
+
+template <class T>
+class ModelStore {
+public:
+    typedef std::shared_ptr<const T> snapshot_type;
+
+    ModelStore() :m_current(new Version(snapshot_type(), 0)) ,m_writeLock() {};
+    explicit ModelStore(const snapshot_type &initial) :m_current(new Version(initial, 1)) ,m_writeLock() {};
+    explicit ModelStore(T *initial) :m_current(new Version(snapshot_type(initial), 1)) ,m_writeLock() {};
+
+    ~ModelStore() { retireVersion(m_current.load()); };
+
+    /* The current version, valid for as long as guard is held, nullptr if
+     * nothing has been published yet */
+    const T *load([[maybe_unused]] const ModelEpoch::Guard &guard) const { return m_current.load(std::memory_order_seq_cst)->value.get(); };
+
+    /* The current version, kept for as long as the returned pointer is held */
+    snapshot_type snapshot() const {
+        ModelEpoch::Guard guard;
+        return m_current.load(std::memory_order_seq_cst)->value;
+    };
+
+    /* Number of versions published, 0 before the first */
+    std::uint64_t version() const {
+        ModelEpoch::Guard guard;
+        return m_current.load(std::memory_order_seq_cst)->version;
+    };
+
+    /* Replace the current version, returns the new version number */
+    std::uint64_t publish(const snapshot_type &value) {
+        std::lock_guard<std::mutex> lock(m_writeLock);
+        return publishLocked(value);
+    };
+    std::uint64_t publish(T *value) { return publish(snapshot_type(value)); };
+
+    /* Publish fn(current), where fn returns a new T* (such as the result of
+     * newWithJSONPatches() or newWithMergePatch()) or a snapshot_type.
+     * Writers are serialised, so fn always sees the latest version. If fn
+     * throws nothing is published. */
+    template <class F>
+    std::uint64_t update(F &&fn) {
+        std::lock_guard<std::mutex> lock(m_writeLock);
+        ModelEpoch::Guard guard;
+        const T *current = load(guard);
+        if (!current) throw ModelException("Runtime Error: ModelStore update before any version was published", "ModelStore", std::string(), ProblemCause::SYSTEM_FAILURE);
+        return publishLocked(snapshot_type(fn(*current)));
+    };
+
+private:
+    struct Version {
+        Version(const snapshot_type &v, std::uint64_t ver) :value(v) ,version(ver) {};
+
+        snapshot_type value;
+        std::uint64_t version;
+    };
+
+    static void deleteVersion(void *ptr) { delete static_cast<Version*>(ptr); };
+    static void retireVersion(Version *version) { ModelEpoch::retire(version, &ModelStore<T>::deleteVersion); };
+
+    std::uint64_t publishLocked(const snapshot_type &value) {
+        Version *previous = m_current.load(std::memory_order_relaxed);
+        Version *next = new Version(value, previous->version + 1);
+        m_current.store(next, std::memory_order_seq_cst);
+        retireVersion(previous);
+        return next->version;
+    };
+
+    ModelStore(const ModelStore&) = delete;
+    ModelStore &operator=(const ModelStore&) = delete;
+
+    std::atomic<Version*> m_current;
+    std::mutex m_writeLock;
+};
+
+} /* end namespace */
+
+/* vim:ts=8:sts=4:sw=4:expandtab:
+ */
+
+#endif /* _OPENAPI_MODEL_STORE_HH_ */
@@ -0,0 +1,345 @@
+/**************************************************************************
+ * OgsAllocStats.cc : Allocation accounting for the Open5GS allocators
+ **************************************************************************
+ * Each thread keeps its own counters which only that thread writes, so
+ * recording an allocation is a handful of relaxed loads and stores with no
+ * locking. The counters are atomics so that snapshot() can read them from
+ * another thread. Threads register themselves on first use and fold their
+ * counters into a retired total when they exit.
+ *
+ * The accounting code must not allocate memory itself while recording, as
+ * it is called from within the allocators.
+ **************************************************************************
+ * License: 5G-MAG Public License (v1.0)
+ * Author: David Waring
+ * Copyright: (C)2025 British Broadcasting Corporation
+ *
+ * For full license terms please see the LICENSE file distributed with this
+ * program. If this file is missing then the license can be retrieved from
+ * https://drive.google.com/file/d/1cinCiA778IErENZ3JN52VFW-1ffHpx7Z/view
+ */
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "CJson.hh"
+#include "OgsAllocator.hh"
+#include "OgsAllocStats.hh"
+
+namespace fiveg_mag_reftools {
+
+std::atomic<bool> OgsAllocStats::s_enabled(false);
+
+namespace {
+
+constexpr std::size_t NumCounterClasses = OgsSlabCache::NumSizeClasses + 1; /* last is "large" */
+constexpr std::size_t LargeClass = OgsSlabCache::NumSizeClasses;
+constexpr std::size_t NumTagSlots = 128;
+constexpr std::size_t NumSnapshotTags = 1024;
+
+/* Single writer counter, readable from other threads */
+struct Counter {
+    std::atomic<std::uint64_t> value;
+
+    void add(std::uint64_t n) noexcept { value.store(value.load(std::memory_order_relaxed) + n, std::memory_order_relaxed); };
+    std::uint64_t get() const noexcept { return value.load(std::memory_order_relaxed); };
+};
+
+struct ClassCounters {
+    Counter allocations;
+    Counter frees;
+    Counter bytes;
+};
+
+struct TagSlot {
+    std::atomic<const char*> tag;
+    Counter allocations;
+    Counter bytes;
+};
+
+enum ThreadStatsState { STATS_UNREGISTERED = 0, STATS_ACTIVE, STATS_RETIRED };
+
+struct ThreadStats {
+    ~ThreadStats();
+
+    ClassCounters classes[NumCounterClasses];
+    TagSlot tags[NumTagSlots];
+    Counter tagOverflow[2];                 /* allocations, bytes when tags is full */
+    ThreadStats *next;
+    ThreadStats *prev;
+};
+
+/* Plain copies of the counters, gathered while holding g_stats_lock.
+ * Nothing may allocate while the lock is held, as the allocation would
+ * re-enter recordAllocation() and so threadStats(), which can take the
+ * lock again, so the Snapshot maps are only built after unlocking. */
+struct RawTagCounters {
+    const char *tag;
+    std::uint64_t allocations;
+    std::uint64_t bytes;
+};
+
+struct RawStats {
+    RawStats() :classes() ,tags() ,tagOverflow() {};
+
+    void add(const ThreadStats &stats) noexcept;
+    void add(const RawStats &other) noexcept;
+    void addTag(const char *tag, std::uint64_t allocations, std::uint64_t bytes) noexcept;
+
+    OgsAllocStats::Counters classes[NumCounterClasses];
+    RawTagCounters tags[NumSnapshotTags];
+    RawTagCounters tagOverflow;
+};
+
+std::mutex g_stats_lock;
+ThreadStats *g_threads = nullptr;
+RawStats *g_retired = nullptr;
+
+thread_local ThreadStats t_stats;
+thread_local ThreadStatsState t_stats_state = STATS_UNREGISTERED;
+thread_local const char *t_current_tag = nullptr;
+
+const char * const OverflowTag = "(tag table full)";
+
+std::size_t counterClass(std::size_t size) noexcept
+{
+    return (size > OgsSlabCache::MaxSmallSize)?LargeClass:OgsSlabCache::sizeClass(size);
+}
+
+void RawStats::add(const ThreadStats &stats) noexcept
+{
+    for (std::size_t i = 0; i < NumCounterClasses; i++) {
+        classes[i].allocations += stats.classes[i].allocations.get();
+        classes[i].frees += stats.classes[i].frees.get();
+        classes[i].bytes += stats.classes[i].bytes.get();
+    }
+    for (std::size_t i = 0; i < NumTagSlots; i++) {
+        const char *tag = stats.tags[i].tag.load(std::memory_order_acquire);
+        if (tag) addTag(tag, stats.tags[i].allocations.get(), stats.tags[i].bytes.get());
+    }
+    tagOverflow.allocations += stats.tagOverflow[0].get();
+    tagOverflow.bytes += stats.tagOverflow[1].get();
+}
+
+void RawStats::add(const RawStats &other) noexcept
+{
+    for (std::size_t i = 0; i < NumCounterClasses; i++) classes[i] += other.classes[i];
+    for (const auto &entry : other.tags) {
+        if (entry.tag) addTag(entry.tag, entry.allocations, entry.bytes);
+    }
+    tagOverflow.allocations += other.tagOverflow.allocations;
+    tagOverflow.bytes += other.tagOverflow.bytes;
+}
+
+void RawStats::addTag(const char *tag, std::uint64_t allocations, std::uint64_t bytes) noexcept
+{
+    std::size_t start = (reinterpret_cast<std::uintptr_t>(tag) >> 3) % NumSnapshotTags;
+    for (std::size_t i = 0; i < NumSnapshotTags; i++) {
+        RawTagCounters &entry = tags[(start + i) % NumSnapshotTags];
+        if (!entry.tag) entry.tag = tag;
+        if (entry.tag == tag) {
+            entry.allocations += allocations;
+            entry.bytes += bytes;
+            return;
+        }
+    }
+    tagOverflow.allocations += allocations;
+    tagOverflow.bytes += bytes;
+}
+
+ThreadStats::~ThreadStats()
+{
+    if (t_stats_state != STATS_ACTIVE) return;
+
+    /* stop recording on this thread before allocating g_retired */
+    t_stats_state = STATS_RETIRED;
+
+    std::lock_guard<std::mutex> lock(g_stats_lock);
+    if (prev) {
+        prev->next = next;
+    } else {
+        g_threads = next;
+    }
+    if (next) next->prev = prev;
+    if (!g_retired) g_retired = new RawStats();
+    g_retired->add(*this);
+}
+
+ThreadStats *threadStats() noexcept
+{
+    if (t_stats_state == STATS_ACTIVE) return &t_stats;
+    if (t_stats_state == STATS_RETIRED) return nullptr;
+
+    std::lock_guard<std::mutex> lock(g_stats_lock);
+    t_stats.prev = nullptr;
+    t_stats.next = g_threads;
+    if (g_threads) g_threads->prev = &t_stats;
+    g_threads = &t_stats;
+    t_stats_state = STATS_ACTIVE;
+    return &t_stats;
+}
+
+void recordTag(ThreadStats &stats, const char *tag, std::size_t size) noexcept
+{
+    std::size_t start = (reinterpret_cast<std::uintptr_t>(tag) >> 3) % NumTagSlots;
+    for (std::size_t i = 0; i < NumTagSlots; i++) {
+        TagSlot &slot = stats.tags[(start + i) % NumTagSlots];
+        const char *slot_tag = slot.tag.load(std::memory_order_relaxed);
+        if (!slot_tag) {
+            slot.tag.store(tag, std::memory_order_release);
+            slot_tag = tag;
+        }
+        if (slot_tag == tag) {
+            slot.allocations.add(1);
+            slot.bytes.add(size);
+            return;
+        }
+    }
+    stats.tagOverflow[0].add(1);
+    stats.tagOverflow[1].add(size);
+}
+
+} /* end anonymous namespace */
+
+void OgsAllocStats::recordAllocation(std::size_t size) noexcept
+{
+    ThreadStats *stats = threadStats();
+    if (!stats) return;
+
+    ClassCounters &counters = stats->classes[counterClass(size)];
+    counters.allocations.add(1);
+    counters.bytes.add(size);
+
+    if (t_current_tag) recordTag(*stats, t_current_tag, size);
+}
+
+void OgsAllocStats::recordDeallocation(std::size_t size) noexcept
+{
+    ThreadStats *stats = threadStats();
+    if (!stats) return;
+
+    stats->classes[counterClass(size)].frees.add(1);
+}
+
+OgsAllocStats::Snapshot OgsAllocStats::snapshot()
+{
+    /* allocated before taking the lock, see RawStats */
+    std::unique_ptr<RawStats> raw(new RawStats());
+
+    {
+        std::lock_guard<std::mutex> lock(g_stats_lock);
+        if (g_retired) raw->add(*g_retired);
+        for (ThreadStats *stats = g_threads; stats; stats = stats->next) {
+            raw->add(*stats);
+        }
+    }
+
+    Snapshot snap;
+    for (std::size_t i = 0; i < OgsSlabCache::NumSizeClasses; i++) snap.sizeClasses[i] = raw->classes[i];
+    snap.large = raw->classes[LargeClass];
+    for (const auto &entry : raw->tags) {
+        if (!entry.tag) continue;
+        Counters &counters = snap.tags[entry.tag];
+        counters.allocations += entry.allocations;
+        counters.bytes += entry.bytes;
+    }
+    if (raw->tagOverflow.allocations) {
+        Counters &counters = snap.tags[OverflowTag];
+        counters.allocations += raw->tagOverflow.allocations;
+        counters.bytes += raw->tagOverflow.bytes;
+    }
+
+    return snap;
+}
+
+OgsAllocStats::Counters &OgsAllocStats::Counters::operator+=(const Counters &other)
+{
+    allocations += other.allocations;
+    frees += other.frees;
+    bytes += other.bytes;
+    return *this;
+}
+
+OgsAllocStats::Counters &OgsAllocStats::Counters::operator-=(const Counters &other)
+{
+    allocations -= other.allocations;
+    frees -= other.frees;
+    bytes -= other.bytes;
+    return *this;
+}
+
+CJson OgsAllocStats::Counters::toJSON() const
+{
+    CJson json = CJson::newObject();
+    json.set("allocations", CJson::newNumber(static_cast<double>(allocations)));
+    json.set("frees", CJson::newNumber(static_cast<double>(frees)));
+    json.set("bytes", CJson::newNumber(static_cast<double>(bytes)));
+    return json;
+}
+
+OgsAllocStats::Counters OgsAllocStats::Snapshot::total() const
+{
+    Counters ret(large);
+    for (const auto &counters : sizeClasses) ret += counters;
+    return ret;
+}
+
+OgsAllocStats::Snapshot &OgsAllocStats::Snapshot::operator-=(const Snapshot &earlier)
+{
+    for (std::size_t i = 0; i < OgsSlabCache::NumSizeClasses; i++) sizeClasses[i] -= earlier.sizeClasses[i];
+    large -= earlier.large;
+    for (const auto &[tag, counters] : earlier.tags) {
+        auto it = tags.find(tag);
+        if (it != tags.end()) it->second -= counters;
+    }
+    return *this;
+}
+
+CJson OgsAllocStats::Snapshot::toJSON() const
+{
+    CJson json = CJson::newObject();
+
+    json.set("total", total().toJSON());
+
+    CJson classes = CJson::newObject();
+    for (std::size_t i = 0; i < OgsSlabCache::NumSizeClasses; i++) {
+        if (!sizeClasses[i].allocations && !sizeClasses[i].frees) continue;
+        classes.set(std::to_string((i + 1) * OgsSlabCache::MinAlignment), sizeClasses[i].toJSON());
+    }
+    if (large.allocations || large.frees) classes.set("large", large.toJSON());
+    json.set("sizeClasses", std::move(classes));
+
+    CJson tags_json = CJson::newObject();
+    for (const auto &[tag, counters] : tags) {
+        if (!counters.allocations) continue;
+        tags_json.set(tag, counters.toJSON());
+    }
+    json.set("tags", std::move(tags_json));
+
+    return json;
+}
+
+OgsAllocTag::OgsAllocTag(const char *tag) noexcept
+    :m_previous(t_current_tag)
+{
+    t_current_tag = tag;
+}
+
+OgsAllocTag::~OgsAllocTag() noexcept
+{
+    t_current_tag = m_previous;
+}
+
+const char *OgsAllocTag::current() noexcept
+{
+    return t_current_tag;
+}
+
+} /* end namespace */
+
+/* vim:ts=8:sts=4:sw=4:expandtab:
+ */
@@ -0,0 +1,102 @@
+/**************************************************************************
+ * OgsAllocStats.hh : Allocation accounting for the Open5GS allocators
+ **************************************************************************
+ * When enabled, every allocation made through OgsAllocator or the global
+ * new/delete overrides is counted in per-thread counters by size class
+ * and, if an OgsAllocTag is in scope on the allocating thread, by tag.
+ * The per-thread counters are merged on demand into a Snapshot which can
+ * be compared against an earlier snapshot or dumped as JSON.
+ **************************************************************************
+ * License: 5G-MAG Public License (v1.0)
+ * Author: David Waring
+ * Copyright: (C)2025 British Broadcasting Corporation
+ *
+ * For full license terms please see the LICENSE file distributed with this
+ * program. If this file is missing then the license can be retrieved from
+ * https://drive.google.com/file/d/1cinCiA778IErENZ3JN52VFW-1ffHpx7Z/view
+ */
+
+#ifndef _OPENAPI_OGS_ALLOC_STATS_HH_
+#define _OPENAPI_OGS_ALLOC_STATS_HH_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+
+#include "CJson.hh"
+#include "OgsAllocator.hh"
+
+namespace fiveg_mag_reftools {
+
+class OgsAllocStats {
+public:
+    struct Counters {
+        Counters() :allocations(0) ,frees(0) ,bytes(0) {};
+
+        Counters &operator+=(const Counters &other);
+        Counters &operator-=(const Counters &other);
+
+        CJson toJSON() const;
+
+        std::uint64_t allocations;
+        std::uint64_t frees;
+        std::uint64_t bytes;        /* bytes requested by the allocations */
+    };
+
+    class Snapshot {
+    public:
+        Snapshot() :sizeClasses() ,large() ,tags() {};
+
+        Counters total() const;
+        Snapshot &operator-=(const Snapshot &earlier);
+        Snapshot operator-(const Snapshot &earlier) const { Snapshot ret(*this); ret -= earlier; return ret; };
+
+        CJson toJSON() const;
+
+        Counters sizeClasses[OgsSlabCache::NumSizeClasses];
+        Counters large;
+        std::map<std::string, Counters> tags;   /* frees are not attributed to tags */
+    };
+
+    static void enable(bool on = true) { s_enabled.store(on, std::memory_order_relaxed); };
+    static bool enabled() { return s_enabled.load(std::memory_order_relaxed); };
+
+    /* Merge the counters from all live threads and all threads which have
+     * exited since the process started */
+    static Snapshot snapshot();
+
+    /* Hooks called by OgsSlabCache, only when enabled() */
+    static void recordAllocation(std::size_t size) noexcept;
+    static void recordDeallocation(std::size_t size) noexcept;
+
+private:
+    OgsAllocStats() = delete;
+
+    static std::atomic<bool> s_enabled;
+};
+
+/* Scoped allocation tag, e.g. the model class name while decoding. Tags
+ * nest, the innermost tag is the one charged. The tag string must outlive
+ * the process (normally a string literal). */
+class OgsAllocTag {
+public:
+    explicit OgsAllocTag(const char *tag) noexcept;
+    ~OgsAllocTag() noexcept;
+
+    static const char *current() noexcept;
+
+private:
+    OgsAllocTag(const OgsAllocTag&) = delete;
+    OgsAllocTag &operator=(const OgsAllocTag&) = delete;
+
+    const char *m_previous;
+};
+
+} /* end namespace */
+
+/* vim:ts=8:sts=4:sw=4:expandtab:
+ */
+
+#endif /* _OPENAPI_OGS_ALLOC_STATS_HH_ */
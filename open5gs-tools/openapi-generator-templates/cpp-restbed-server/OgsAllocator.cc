@@ -3,10 +3,21 @@
  **************************************************************************
  * This provides overrides for the global new and delete functions so that
  * Open5GS memory allocation functions are used.
+ *
+ * Requests of up to OgsSlabCache::MaxSmallSize bytes are carved from slabs
+ * obtained with ogs_malloc() and recycled through per-thread free lists,
+ * one per size class. Threads exchange batches of free blocks with a shared
+ * depot so that memory freed on a different thread to the one that
+ * allocated it is not lost. Larger and over-aligned requests are passed
+ * through to ogs_malloc()/ogs_free().
+ *
+ * Every block is preceded by a small header recording its size class (or
+ * the offset back to the ogs_malloc() block for large allocations) so that
+ * unsized delete can find its way back to the correct free list.
  **************************************************************************
  * License: 5G-MAG Public License (v1.0)
  * Author: David Waring
- * Copyright: (C)2024 British Broadcasting Corporation
+ * Copyright: (C)2024-2025 British Broadcasting Corporation
  *
  * For full license terms please see the LICENSE file distributed with this
  * program. If this file is missing then the license can be retrieved from
@@ -19,29 +30,410 @@
 #include "core/ogs-memory.h"
 #undef OGS_CORE_INSIDE
 
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <new>
+
+#include "OgsAllocator.hh"
+#include "OgsAllocStats.hh"
+
+namespace fiveg_mag_reftools {
+
+namespace {
+
+/* Header placed immediately before every block handed out */
+struct BlockHeader {
+    std::uint32_t sizeClass;    /* size class index or LargeBlock */
+    std::uint32_t offset;       /* LargeBlock: offset from the ogs_malloc() pointer */
+    std::uint64_t size;         /* LargeBlock: requested size, also keeps the payload 16 byte aligned */
+};
+
+static_assert(sizeof(BlockHeader) == OgsSlabCache::MinAlignment, "BlockHeader must preserve alignment");
+
+constexpr std::uint32_t LargeBlock = 0xffffffffu;
+constexpr std::size_t SlabSize = 64 * 1024;
+
+/* A free block re-uses its payload as the free list link */
+struct FreeBlock {
+    FreeBlock *next;
+};
+
+struct FreeList {
+    FreeBlock *head;
+    std::size_t count;
+};
+
+constexpr std::size_t blockSize(std::size_t size_class)
+{
+    return sizeof(BlockHeader) + (size_class + 1) * OgsSlabCache::MinAlignment;
+}
+
+/* Number of blocks moved between a thread cache and the depot at a time */
+constexpr std::size_t batchSize(std::size_t size_class)
+{
+    return (16 * 1024 / blockSize(size_class)) < 8 ? 8 : (16 * 1024 / blockSize(size_class));
+}
+
+inline BlockHeader *headerFor(void *ptr)
+{
+    return reinterpret_cast<BlockHeader*>(ptr) - 1;
+}
+
+inline void *payloadFor(BlockHeader *hdr)
+{
+    return reinterpret_cast<void*>(hdr + 1);
+}
+
+/* Shared depot of free blocks, only constant initialised and trivially
+ * destructible state so that it outlives every thread cache */
+std::mutex g_depot_lock;
+FreeList g_depot[OgsSlabCache::NumSizeClasses];
+
+/* Per-thread caches, the arrays are trivially destructible so they remain
+ * usable (via the depot) even after the thread exit guard has run */
+enum ThreadCacheState { CACHE_UNINITIALISED = 0, CACHE_ACTIVE, CACHE_RETIRED };
+
+thread_local FreeList t_cache[OgsSlabCache::NumSizeClasses];
+thread_local ThreadCacheState t_cache_state = CACHE_UNINITIALISED;
+
+struct ThreadCacheGuard {
+    ~ThreadCacheGuard() {
+        OgsSlabCache::releaseThreadCache();
+        t_cache_state = CACHE_RETIRED;
+    };
+};
+
+thread_local ThreadCacheGuard t_cache_guard;
+
+void pushList(FreeList &list, FreeBlock *first, FreeBlock *last, std::size_t count)
+{
+    last->next = list.head;
+    list.head = first;
+    list.count += count;
+}
+
+/* Carve a new slab into blocks of the given size class and add them to list */
+bool carveSlab(std::size_t size_class, FreeList &list)
+{
+    std::size_t bsize = blockSize(size_class);
+    char *slab = reinterpret_cast<char*>(ogs_malloc(SlabSize));
+    if (!slab) return false;
+
+    /* ogs_malloc() does not promise more than pointer alignment */
+    std::uintptr_t start = (reinterpret_cast<std::uintptr_t>(slab) + OgsSlabCache::MinAlignment - 1) &
+                                                                            ~(OgsSlabCache::MinAlignment - 1);
+    std::uintptr_t end = reinterpret_cast<std::uintptr_t>(slab) + SlabSize;
+    std::size_t count = (end - start) / bsize;
+
+    FreeBlock *first = nullptr;
+    FreeBlock *last = nullptr;
+    for (std::size_t i = 0; i < count; i++) {
+        BlockHeader *hdr = reinterpret_cast<BlockHeader*>(start + i * bsize);
+        hdr->sizeClass = static_cast<std::uint32_t>(size_class);
+        hdr->offset = 0;
+        hdr->size = 0;
+        FreeBlock *blk = reinterpret_cast<FreeBlock*>(payloadFor(hdr));
+        blk->next = nullptr;
+        if (last) {
+            last->next = blk;
+        } else {
+            first = blk;
+        }
+        last = blk;
+    }
+
+    pushList(list, first, last, count);
+    return true;
+}
+
+/* Move up to one batch from the depot into list, carving a new slab if the
+ * depot is empty */
+bool refill(std::size_t size_class, FreeList &list)
+{
+    std::lock_guard<std::mutex> lock(g_depot_lock);
+    FreeList &depot = g_depot[size_class];
+
+    if (!depot.head) return carveSlab(size_class, list);
+
+    std::size_t want = batchSize(size_class);
+    FreeBlock *first = depot.head;
+    FreeBlock *last = first;
+    std::size_t count = 1;
+    while (count < want && last->next) {
+        last = last->next;
+        count++;
+    }
+    depot.head = last->next;
+    depot.count -= count;
+    pushList(list, first, last, count);
+    return true;
+}
+
+/* Return one batch from a thread cache to the depot */
+void spill(std::size_t size_class, FreeList &list)
+{
+    std::size_t want = batchSize(size_class);
+    FreeBlock *first = list.head;
+    FreeBlock *last = first;
+    std::size_t count = 1;
+    while (count < want && last->next) {
+        last = last->next;
+        count++;
+    }
+    list.head = last->next;
+    list.count -= count;
+
+    std::lock_guard<std::mutex> lock(g_depot_lock);
+    pushList(g_depot[size_class], first, last, count);
+}
+
+FreeList *threadCache()
+{
+    if (t_cache_state == CACHE_ACTIVE) return t_cache;
+    if (t_cache_state == CACHE_RETIRED) return nullptr;
+    /* first use on this thread: odr-use the guard so it is registered for
+     * destruction at thread exit */
+    (void)&t_cache_guard;
+    t_cache_state = CACHE_ACTIVE;
+    return t_cache;
+}
+
+void *allocateSmall(std::size_t size_class)
+{
+    FreeList *cache = threadCache();
+
+    if (!cache) {
+        /* thread is exiting, work directly with the depot */
+        std::lock_guard<std::mutex> lock(g_depot_lock);
+        FreeList &depot = g_depot[size_class];
+        if (!depot.head && !carveSlab(size_class, depot)) return nullptr;
+        FreeBlock *blk = depot.head;
+        depot.head = blk->next;
+        depot.count--;
+        return blk;
+    }
+
+    FreeList &list = cache[size_class];
+    if (!list.head && !refill(size_class, list)) return nullptr;
+    FreeBlock *blk = list.head;
+    list.head = blk->next;
+    list.count--;
+    return blk;
+}
+
+void deallocateSmall(void *ptr, std::size_t size_class)
+{
+    FreeBlock *blk = reinterpret_cast<FreeBlock*>(ptr);
+    FreeList *cache = threadCache();
+
+    if (!cache) {
+        std::lock_guard<std::mutex> lock(g_depot_lock);
+        pushList(g_depot[size_class], blk, blk, 1);
+        return;
+    }
+
+    FreeList &list = cache[size_class];
+    pushList(list, blk, blk, 1);
+    if (list.count > 2 * batchSize(size_class)) spill(size_class, list);
+}
+
+void *allocateLarge(std::size_t size, std::size_t alignment)
+{
+    if (alignment < OgsSlabCache::MinAlignment) alignment = OgsSlabCache::MinAlignment;
+    if (size > std::numeric_limits<std::size_t>::max() - sizeof(BlockHeader) - alignment) return nullptr;
+
+    char *raw = reinterpret_cast<char*>(ogs_malloc(size + sizeof(BlockHeader) + alignment - 1));
+    if (!raw) return nullptr;
+
+    std::uintptr_t user = (reinterpret_cast<std::uintptr_t>(raw) + sizeof(BlockHeader) + alignment - 1) &
+                                                                                        ~(alignment - 1);
+    BlockHeader *hdr = headerFor(reinterpret_cast<void*>(user));
+    hdr->sizeClass = LargeBlock;
+    hdr->offset = static_cast<std::uint32_t>(user - reinterpret_cast<std::uintptr_t>(raw));
+    hdr->size = size;
+    return reinterpret_cast<void*>(user);
+}
+
+} /* end anonymous namespace */
+
+void *OgsSlabCache::allocate(std::size_t size)
+{
+    if (OgsAllocStats::enabled()) OgsAllocStats::recordAllocation(size);
+    if (size <= MaxSmallSize) return allocateSmall(sizeClass(size));
+    return allocateLarge(size, MinAlignment);
+}
+
+void *OgsSlabCache::allocate(std::size_t size, std::size_t alignment)
+{
+    if (alignment <= MinAlignment) return allocate(size);
+    if (OgsAllocStats::enabled()) OgsAllocStats::recordAllocation(size);
+    return allocateLarge(size, alignment);
+}
+
+void OgsSlabCache::deallocate(void *ptr) noexcept
+{
+    if (!ptr) return;
+
+    BlockHeader *hdr = headerFor(ptr);
+    if (hdr->sizeClass == LargeBlock) {
+        if (OgsAllocStats::enabled()) OgsAllocStats::recordDeallocation(hdr->size);
+        ogs_free(reinterpret_cast<char*>(ptr) - hdr->offset);
+    } else {
+        if (OgsAllocStats::enabled()) OgsAllocStats::recordDeallocation((hdr->sizeClass + 1) * MinAlignment);
+        deallocateSmall(ptr, hdr->sizeClass);
+    }
+}
+
+void OgsSlabCache::deallocate(void *ptr, std::size_t size) noexcept
+{
+    if (!ptr) return;
+
+    if (OgsAllocStats::enabled()) OgsAllocStats::recordDeallocation(size);
+
+    /* small blocks can skip the header lookup, the size gives the class */
+    if (size <= MaxSmallSize) {
+        deallocateSmall(ptr, sizeClass(size));
+    } else {
+        BlockHeader *hdr = headerFor(ptr);
+        ogs_free(reinterpret_cast<char*>(ptr) - hdr->offset);
+    }
+}
+
+void OgsSlabCache::releaseThreadCache() noexcept
+{
+    if (t_cache_state != CACHE_ACTIVE) return;
+
+    std::lock_guard<std::mutex> lock(g_depot_lock);
+    for (std::size_t size_class = 0; size_class < NumSizeClasses; size_class++) {
+        FreeList &list = t_cache[size_class];
+        if (!list.head) continue;
+        FreeBlock *last = list.head;
+        while (last->next) last = last->next;
+        pushList(g_depot[size_class], list.head, last, list.count);
+        list.head = nullptr;
+        list.count = 0;
+    }
+}
+
+} /* end namespace */
+
+using fiveg_mag_reftools::OgsSlabCache;
+
+static inline void *ogs_new(size_t size)
+{
+    void *ptr = OgsSlabCache::allocate(size);
+    if (!ptr) throw std::bad_alloc();
+    return ptr;
+}
+
+static inline void *ogs_new(size_t size, std::align_val_t alignment)
+{
+    void *ptr = OgsSlabCache::allocate(size, static_cast<std::size_t>(alignment));
+    if (!ptr) throw std::bad_alloc();
+    return ptr;
+}
+
 void *operator new[](size_t size)
 {
-    return ogs_malloc(size);
+    return ogs_new(size);
 }
 
 void *operator new(size_t size)
 {
-    return ogs_malloc(size);
+    return ogs_new(size);
+}
+
+void *operator new(size_t size, const std::nothrow_t &) noexcept
+{
+    return OgsSlabCache::allocate(size);
+}
+
+void *operator new[](size_t size, const std::nothrow_t &) noexcept
+{
+    return OgsSlabCache::allocate(size);
+}
+
+void *operator new(size_t size, std::align_val_t alignment)
+{
+    return ogs_new(size, alignment);
+}
+
+void *operator new[](size_t size, std::align_val_t alignment)
+{
+    return ogs_new(size, alignment);
+}
+
+void *operator new(size_t size, std::align_val_t alignment, const std::nothrow_t &) noexcept
+{
+    return OgsSlabCache::allocate(size, static_cast<std::size_t>(alignment));
+}
+
+void *operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t &) noexcept
+{
+    return OgsSlabCache::allocate(size, static_cast<std::size_t>(alignment));
+}
+
+void operator delete(void *ptr) noexcept
+{
+    OgsSlabCache::deallocate(ptr);
+}
+
+void operator delete(void *ptr, size_t size) noexcept
+{
+    OgsSlabCache::deallocate(ptr, size);
+}
+
+void operator delete[](void *ptr) noexcept
+{
+    OgsSlabCache::deallocate(ptr);
+}
+
+void operator delete[](void *ptr, size_t size) noexcept
+{
+    OgsSlabCache::deallocate(ptr, size);
+}
+
+void operator delete(void *ptr, const std::nothrow_t &) noexcept
+{
+    OgsSlabCache::deallocate(ptr);
+}
+
+void operator delete[](void *ptr, const std::nothrow_t &) noexcept
+{
+    OgsSlabCache::deallocate(ptr);
+}
+
+/* Over-aligned blocks always come from ogs_malloc() so the size is not
+ * needed to find them */
+void operator delete(void *ptr, std::align_val_t) noexcept
+{
+    OgsSlabCache::deallocate(ptr);
+}
+
+void operator delete[](void *ptr, std::align_val_t) noexcept
+{
+    OgsSlabCache::deallocate(ptr);
+}
+
+void operator delete(void *ptr, size_t, std::align_val_t) noexcept
+{
+    OgsSlabCache::deallocate(ptr);
 }
 
-void operator delete(void *ptr)
+void operator delete[](void *ptr, size_t, std::align_val_t) noexcept
 {
-    ogs_free(ptr);
+    OgsSlabCache::deallocate(ptr);
 }
 
-void operator delete(void *ptr, unsigned long __size)
+void operator delete(void *ptr, std::align_val_t, const std::nothrow_t &) noexcept
 {
-    ogs_free(ptr);
+    OgsSlabCache::deallocate(ptr);
 }
 
-void operator delete[](void *ptr)
+void operator delete[](void *ptr, std::align_val_t, const std::nothrow_t &) noexcept
 {
-    ogs_free(ptr);
+    OgsSlabCache::deallocate(ptr);
 }
 
 /* vim:ts=8:sts=4:sw=4:expandtab:
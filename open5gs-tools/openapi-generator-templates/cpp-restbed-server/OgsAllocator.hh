@@ -3,10 +3,16 @@
  **************************************************************************
  * This is a std::allocator which uses the Open5GS memmory allocation
  * functions.
+ *
+ * Small allocations are served from per-thread size-class slab caches
+ * (OgsSlabCache) which are refilled from larger blocks obtained with
+ * ogs_malloc(), so that the many small strings, list nodes and model
+ * objects created while decoding a message do not each go through the
+ * Open5GS allocator.
  **************************************************************************
  * License: 5G-MAG Public License (v1.0)
  * Author: David Waring
- * Copyright: (C)2024 British Broadcasting Corporation
+ * Copyright: (C)2024-2025 British Broadcasting Corporation
  *
  * For full license terms please see the LICENSE file distributed with this
  * program. If this file is missing then the license can be retrieved from
@@ -22,11 +28,36 @@
 #include "core/ogs-memory.h"
 #undef OGS_CORE_INSIDE
 
+#include <cstddef>
 #include <memory>
 #include <limits>
 
 namespace fiveg_mag_reftools {
 
+class OgsSlabCache {
+public:
+    /* Size classes are multiples of the minimum alignment up to a maximum,
+     * anything larger goes straight to ogs_malloc() */
+    static constexpr std::size_t MinAlignment = 16;
+    static constexpr std::size_t MaxSmallSize = 512;
+    static constexpr std::size_t NumSizeClasses = MaxSmallSize / MinAlignment;
+
+    static void *allocate(std::size_t size);
+    static void *allocate(std::size_t size, std::size_t alignment);
+    static void deallocate(void *ptr) noexcept;
+    static void deallocate(void *ptr, std::size_t size) noexcept;
+
+    /* Return the blocks cached by the calling thread to the shared depot */
+    static void releaseThreadCache() noexcept;
+
+    static constexpr std::size_t sizeClass(std::size_t size) noexcept {
+        return size?((size + MinAlignment - 1) / MinAlignment - 1):0;
+    };
+
+private:
+    OgsSlabCache() = delete;
+};
+
 template <class T>
 class OgsAllocator {
 public:
@@ -66,12 +97,20 @@ public:
 
     pointer allocate(size_type n, const void *hint = nullptr)
     {
-        return (pointer)ogs_malloc(n * sizeof(T));
+        if constexpr (alignof(T) > OgsSlabCache::MinAlignment) {
+            return (pointer)OgsSlabCache::allocate(n * sizeof(T), alignof(T));
+        } else {
+            return (pointer)OgsSlabCache::allocate(n * sizeof(T));
+        }
     };
 
     void deallocate(pointer p, size_type n)
     {
-        ogs_free(p);
+        if constexpr (alignof(T) > OgsSlabCache::MinAlignment) {
+            OgsSlabCache::deallocate(p);
+        } else {
+            OgsSlabCache::deallocate(p, n * sizeof(T));
+        }
     };
 
     void construct (pointer p, const_reference value) {
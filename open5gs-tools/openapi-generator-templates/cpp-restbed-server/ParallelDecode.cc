@@ -0,0 +1,143 @@
+/**************************************************************************
+ * ParallelDecode.cc : Parallel decoding and validation of large arrays
+ **************************************************************************
+ * License: 5G-MAG Public License (v1.0)
+ * Author: David Waring
+ * Copyright: (C)2025 British Broadcasting Corporation
+ *
+ * For full license terms please see the LICENSE file distributed with this
+ * program. If this file is missing then the license can be retrieved from
+ * https://drive.google.com/file/d/1cinCiA778IErENZ3JN52VFW-1ffHpx7Z/view
+ */
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "ParallelDecode.hh"
+
+namespace fiveg_mag_reftools {
+
+std::atomic<std::size_t> ParallelDecode::s_threshold(std::numeric_limits<std::size_t>::max());
+thread_local bool ParallelDecode::s_inTask = false;
+
+static std::atomic<std::shared_ptr<DecodeExecutor> > g_executor;
+
+void ParallelDecode::enable(const std::shared_ptr<DecodeExecutor> &executor, std::size_t threshold)
+{
+    g_executor.store(executor);
+    s_threshold.store(std::max<std::size_t>(threshold, 1), std::memory_order_relaxed);
+}
+
+void ParallelDecode::disable()
+{
+    s_threshold.store(std::numeric_limits<std::size_t>::max(), std::memory_order_relaxed);
+    g_executor.store(std::shared_ptr<DecodeExecutor>());
+}
+
+std::shared_ptr<DecodeExecutor> ParallelDecode::executor()
+{
+    return g_executor.load();
+}
+
+struct ThreadPoolDecodeExecutor::Job {
+    Job(std::size_t n, const std::function<void(std::size_t)> &t) :count(n) ,task(t) ,next(0) ,done(0) ,lock() ,finished() {};
+
+    /* Run tasks until there are none left to start */
+    void work() {
+        std::size_t ran = 0;
+        for (std::size_t i = next.fetch_add(1); i < count; i = next.fetch_add(1)) {
+            task(i);
+            ran++;
+        }
+        if (ran) {
+            std::lock_guard<std::mutex> guard(lock);
+            done += ran;
+            if (done == count) finished.notify_all();
+        }
+    };
+
+    bool exhausted() const { return next.load() >= count; };
+
+    std::size_t count;
+    const std::function<void(std::size_t)> &task;
+    std::atomic<std::size_t> next;
+    std::size_t done;
+    std::mutex lock;
+    std::condition_variable finished;
+};
+
+ThreadPoolDecodeExecutor::ThreadPoolDecodeExecutor(std::size_t threads)
+    :m_lock()
+    ,m_wake()
+    ,m_jobs()
+    ,m_stopping(false)
+    ,m_threads()
+{
+    /* the thread calling run() also works on its job */
+    for (std::size_t i = 1; i < threads; i++) {
+        m_threads.emplace_back(&ThreadPoolDecodeExecutor::worker, this);
+    }
+}
+
+ThreadPoolDecodeExecutor::~ThreadPoolDecodeExecutor()
+{
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+        m_stopping = true;
+    }
+    m_wake.notify_all();
+    for (auto &thread : m_threads) thread.join();
+}
+
+void ThreadPoolDecodeExecutor::run(std::size_t count, const std::function<void(std::size_t)> &task)
+{
+    if (count == 0) return;
+
+    std::shared_ptr<Job> job(std::make_shared<Job>(count, task));
+    if (count > 1 && !m_threads.empty()) {
+        {
+            std::lock_guard<std::mutex> guard(m_lock);
+            m_jobs.push_back(job);
+        }
+        m_wake.notify_all();
+    }
+
+    job->work();
+
+    {
+        std::unique_lock<std::mutex> guard(job->lock);
+        job->finished.wait(guard, [&job]() { return job->done == job->count; });
+    }
+
+    std::lock_guard<std::mutex> guard(m_lock);
+    m_jobs.remove(job);
+}
+
+void ThreadPoolDecodeExecutor::worker()
+{
+    while (true) {
+        std::shared_ptr<Job> job;
+        {
+            std::unique_lock<std::mutex> guard(m_lock);
+            m_wake.wait(guard, [this]() { return m_stopping || !m_jobs.empty(); });
+            if (m_stopping) return;
+            job = m_jobs.front();
+            if (job->exhausted()) {
+                m_jobs.pop_front();
+                continue;
+            }
+        }
+        job->work();
+    }
+}
+
+} /* end namespace */
+
+/* vim:ts=8:sts=4:sw=4:expandtab:
+ */
@@ -0,0 +1,161 @@
+/**************************************************************************
+ * ParallelDecode.hh : Parallel decoding and validation of large arrays
+ **************************************************************************
+ * Opt-in support for spreading the decoding and validation of the
+ * elements of very large arrays across several threads. When enabled,
+ * arrays with at least the configured number of elements are split into
+ * chunks which are handed to a DecodeExecutor. The results are kept in the
+ * original order, and if any elements fail the error reported is the one
+ * for the lowest index, exactly as for sequential decoding.
+ *
+ * Nested arrays are decoded sequentially when already running on behalf of
+ * a parallel decode, so a pool cannot deadlock waiting on itself.
+ *
+ *   ParallelDecode::enable(std::make_shared<ThreadPoolDecodeExecutor>(), 4096);
+ **************************************************************************
+ * License: 5G-MAG Public License (v1.0)
+ * Author: David Waring
+ * Copyright: (C)2025 British Broadcasting Corporation
+ *
+ * For full license terms please see the LICENSE file distributed with this
+ * program. If this file is missing then the license can be retrieved from
+ * https://drive.google.com/file/d/1cinCiA778IErENZ3JN52VFW-1ffHpx7Z/view
+ */
+
+#ifndef _OPENAPI_PARALLEL_DECODE_HH_
+#define _OPENAPI_PARALLEL_DECODE_HH_
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <limits>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace fiveg_mag_reftools {
+
+/* Runs the chunks of a parallel decode, implement this to use an existing
+ * thread pool */
+class DecodeExecutor {
+public:
+    virtual ~DecodeExecutor() {};
+
+    /* Call task(i) for every i in [0, count) and return once all calls have
+     * completed. task does not throw. */
+    virtual void run(std::size_t count, const std::function<void(std::size_t)> &task) = 0;
+};
+
+/* Fixed pool of worker threads. The calling thread works on its own job as
+ * well, and idle workers take the next chunk of the oldest job from a
+ * shared counter, so uneven chunks balance themselves out. */
+class ThreadPoolDecodeExecutor : public DecodeExecutor {
+public:
+    explicit ThreadPoolDecodeExecutor(std::size_t threads = std::thread::hardware_concurrency());
+    virtual ~ThreadPoolDecodeExecutor();
+
+    virtual void run(std::size_t count, const std::function<void(std::size_t)> &task);
+
+private:
+    struct Job;
+
+    ThreadPoolDecodeExecutor(const ThreadPoolDecodeExecutor&) = delete;
+    ThreadPoolDecodeExecutor &operator=(const ThreadPoolDecodeExecutor&) = delete;
+
+    void worker();
+
+    std::mutex m_lock;
+    std::condition_variable m_wake;
+    std::list<std::shared_ptr<Job> > m_jobs;
+    bool m_stopping;
+    std::vector<std::thread> m_threads;
+};
+
+class ParallelDecode {
+public:
+    static constexpr std::size_t DefaultThreshold = 4096;
+
+    /* Decode and validate arrays of at least threshold elements using
+     * executor */
+    static void enable(const std::shared_ptr<DecodeExecutor> &executor, std::size_t threshold = DefaultThreshold);
+    static void disable();
+
+    /* true if parallel decoding has been enabled, cheap enough to check
+     * before counting the elements of an array */
+    static bool enabled() {
+        return s_threshold.load(std::memory_order_relaxed) != std::numeric_limits<std::size_t>::max();
+    };
+
+    /* true if an array of count elements should be handled in parallel */
+    static bool useFor(std::size_t count) {
+        return count >= s_threshold.load(std::memory_order_relaxed) && !s_inTask;
+    };
+
+    /* Call fn(i) for every i in [0, count), in chunks on the executor. If
+     * any calls throw, the exception thrown for the lowest i is rethrown
+     * once all chunks have finished. */
+    template <class F>
+    static void forEach(std::size_t count, F &&fn);
+
+private:
+    ParallelDecode() = delete;
+
+    static std::shared_ptr<DecodeExecutor> executor();
+
+    static std::atomic<std::size_t> s_threshold;
+    static thread_local bool s_inTask;
+};
+
+template <class F>
+void ParallelDecode::forEach(std::size_t count, F &&fn)
+{
+    std::shared_ptr<DecodeExecutor> exec(executor());
+    if (!exec) {
+        for (std::size_t i = 0; i < count; i++) fn(i);
+        return;
+    }
+
+    std::size_t chunk_size = std::max<std::size_t>(count / 64, 256);
+    std::size_t chunks = (count + chunk_size - 1) / chunk_size;
+
+    std::mutex error_lock;
+    std::size_t error_index = std::numeric_limits<std::size_t>::max();
+    std::exception_ptr error;
+    std::atomic<std::size_t> lowest_error(std::numeric_limits<std::size_t>::max());
+
+    exec->run(chunks, [&](std::size_t chunk) {
+        bool was_in_task = s_inTask;
+        s_inTask = true;
+        std::size_t end = std::min(count, (chunk + 1) * chunk_size);
+        for (std::size_t i = chunk * chunk_size; i < end; i++) {
+            /* an earlier element has already failed */
+            if (i > lowest_error.load(std::memory_order_relaxed)) break;
+            try {
+                fn(i);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(error_lock);
+                if (i < error_index) {
+                    error_index = i;
+                    error = std::current_exception();
+                    lowest_error.store(i, std::memory_order_relaxed);
+                }
+                break;
+            }
+        }
+        s_inTask = was_in_task;
+    });
+
+    if (error) std::rethrow_exception(error);
+}
+
+} /* end namespace */
+
+/* vim:ts=8:sts=4:sw=4:expandtab:
+ */
+
+#endif /* _OPENAPI_PARALLEL_DECODE_HH_ */
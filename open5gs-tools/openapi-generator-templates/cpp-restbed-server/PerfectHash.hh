@@ -0,0 +1,192 @@
+/**************************************************************************
+ * PerfectHash.hh : Compile time perfect hash of a fixed set of strings
+ **************************************************************************
+ * PerfectHash maps each of a fixed set of N strings to its 1-based position
+ * in that set, and any other string to 0. The 1-based numbering matches
+ * the mustache {{-index}} of the generating loop, so generated code can
+ * switch on the result of find().
+ *
+ * The table is built at compile time using hash and displace: keys are
+ * first split into buckets by one half of their (mixed) FNV-1a hash, then, largest
+ * buckets first, a seed is found for each bucket which scatters all of its
+ * keys into free slots. The keys are grouped by bucket once, so each seed
+ * tried only touches the keys of its own bucket and the build stays well
+ * inside the compiler's constexpr limits for thousands of keys. A lookup
+ * is one hash of the key, two table reads and a single length-then-memcmp
+ * comparison.
+ **************************************************************************
+ * License: 5G-MAG Public License (v1.0)
+ * Author: David Waring
+ * Copyright: (C)2025 British Broadcasting Corporation
+ *
+ * For full license terms please see the LICENSE file distributed with this
+ * program. If this file is missing then the license can be retrieved from
+ * https://drive.google.com/file/d/1cinCiA778IErENZ3JN52VFW-1ffHpx7Z/view
+ */
+
+#ifndef _OPENAPI_PERFECT_HASH_HH_
+#define _OPENAPI_PERFECT_HASH_HH_
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string_view>
+#include <vector>
+
+namespace fiveg_mag_reftools {
+
+template <std::size_t N>
+class PerfectHash {
+public:
+    static_assert(N < 65535, "PerfectHash supports at most 65534 keys");
+
+    constexpr explicit PerfectHash(const std::array<std::string_view, N> &keys)
+        :m_keys(keys)
+        ,m_seeds()
+        ,m_slots()
+    {
+        build();
+    };
+
+    /* 1-based index of key in the original set, or 0 if not present */
+    constexpr std::size_t find(std::string_view key) const noexcept {
+        if constexpr (N == 0) {
+            return 0;
+        } else {
+            std::uint64_t h = hash(key);
+            std::size_t idx = m_slots[slot(h, m_seeds[bucket(h)])];
+            return (idx && m_keys[idx - 1] == key) ? idx : 0;
+        }
+    };
+
+    constexpr std::size_t size() const noexcept { return N; };
+
+    /* The key at 1-based index */
+    constexpr std::string_view key(std::size_t index) const { return m_keys[index - 1]; };
+
+private:
+    static constexpr std::size_t roundUpPow2(std::size_t value) {
+        std::size_t ret = 1;
+        while (ret < value) ret <<= 1;
+        return ret;
+    };
+
+    static constexpr std::size_t TableSize = roundUpPow2(N * 2);
+    static constexpr std::size_t NumBuckets = roundUpPow2((N + 1) / 2);
+    static constexpr std::uint32_t MaxSeed = 0x100000;
+
+    /* FNV-1a, finished with a mix as the upper bits of FNV-1a, which pick
+     * the bucket, hardly vary between short keys with a common prefix */
+    static constexpr std::uint64_t hash(std::string_view key) noexcept {
+        std::uint64_t h = 0xcbf29ce484222325ULL;
+        for (auto c : key) {
+            h ^= static_cast<unsigned char>(c);
+            h *= 0x100000001b3ULL;
+        }
+        h ^= h >> 29;
+        h *= 0xbf58476d1ce4e5b9ULL;
+        h ^= h >> 32;
+        return h;
+    };
+
+    static constexpr std::size_t bucket(std::uint64_t h) noexcept {
+        return static_cast<std::size_t>(h >> 32) & (NumBuckets - 1);
+    };
+
+    static constexpr std::size_t slot(std::uint64_t h, std::uint32_t seed) noexcept {
+        h ^= seed * 0x9e3779b97f4a7c15ULL;
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdULL;
+        h ^= h >> 33;
+        return static_cast<std::size_t>(h) & (TableSize - 1);
+    };
+
+    constexpr void build() {
+        if constexpr (N > 0) {
+            std::array<std::uint64_t, N> hashes{};
+            std::array<std::size_t, NumBuckets + 1> bucket_offsets{};
+            std::array<std::size_t, N> by_bucket{};
+            std::array<std::size_t, NumBuckets> bucket_order{};
+            std::size_t largest = 0;
+
+            for (std::size_t i = 0; i < N; i++) {
+                hashes[i] = hash(m_keys[i]);
+                bucket_offsets[bucket(hashes[i]) + 1]++;
+            }
+            checkUnique(hashes);
+
+            /* Group the key indices by bucket, the keys of bucket b are
+             * by_bucket[bucket_offsets[b]] to by_bucket[bucket_offsets[b+1]-1] */
+            for (std::size_t b = 0; b < NumBuckets; b++) {
+                if (bucket_offsets[b + 1] > largest) largest = bucket_offsets[b + 1];
+                bucket_offsets[b + 1] += bucket_offsets[b];
+                bucket_order[b] = b;
+            }
+            {
+                std::array<std::size_t, NumBuckets> fill{};
+                for (std::size_t i = 0; i < N; i++) {
+                    std::size_t b = bucket(hashes[i]);
+                    by_bucket[bucket_offsets[b] + fill[b]++] = i;
+                }
+            }
+
+            /* Place the largest buckets first, while the table is emptiest */
+            std::sort(bucket_order.begin(), bucket_order.end(), [&bucket_offsets](std::size_t a, std::size_t b) {
+                return bucket_offsets[a + 1] - bucket_offsets[a] > bucket_offsets[b + 1] - bucket_offsets[b];
+            });
+
+            std::vector<std::size_t> placed(largest);
+            for (std::size_t b : bucket_order) {
+                if (bucket_offsets[b + 1] == bucket_offsets[b]) break;
+                placeBucket(b, hashes, by_bucket.data() + bucket_offsets[b], bucket_offsets[b + 1] - bucket_offsets[b], placed);
+            }
+        }
+    };
+
+    /* Equal keys have equal hashes, so only keys with the same hash need to
+     * be compared once the indices are sorted by hash */
+    constexpr void checkUnique(const std::array<std::uint64_t, N> &hashes) const {
+        std::array<std::size_t, N> by_hash{};
+        for (std::size_t i = 0; i < N; i++) by_hash[i] = i;
+        std::sort(by_hash.begin(), by_hash.end(), [&hashes](std::size_t a, std::size_t b) { return hashes[a] < hashes[b]; });
+
+        for (std::size_t i = 1; i < N; i++) {
+            for (std::size_t j = i; j > 0 && hashes[by_hash[j - 1]] == hashes[by_hash[i]]; j--) {
+                if (m_keys[by_hash[j - 1]] == m_keys[by_hash[i]]) throw std::logic_error("PerfectHash keys must be unique");
+            }
+        }
+    };
+
+    constexpr void placeBucket(std::size_t b, const std::array<std::uint64_t, N> &hashes, const std::size_t *keys, std::size_t num_keys, std::vector<std::size_t> &placed) {
+        for (std::uint32_t seed = 0; seed < MaxSeed; seed++) {
+            std::size_t num_placed = 0;
+
+            for (; num_placed < num_keys; num_placed++) {
+                std::size_t s = slot(hashes[keys[num_placed]], seed);
+                if (m_slots[s]) break;
+                m_slots[s] = static_cast<std::uint16_t>(keys[num_placed] + 1);
+                placed[num_placed] = s;
+            }
+
+            if (num_placed == num_keys) {
+                m_seeds[b] = seed;
+                return;
+            }
+            for (std::size_t i = 0; i < num_placed; i++) m_slots[placed[i]] = 0;
+        }
+        throw std::logic_error("PerfectHash unable to find a seed");
+    };
+
+    std::array<std::string_view, N> m_keys;
+    std::array<std::uint32_t, NumBuckets> m_seeds;
+    std::array<std::uint16_t, TableSize> m_slots;    /* 0 = empty, otherwise 1-based key index */
+};
+
+} /* end namespace */
+
+/* vim:ts=8:sts=4:sw=4:expandtab:
+ */
+
+#endif /* _OPENAPI_PERFECT_HASH_HH_ */
@@ -0,0 +1,91 @@
+/**************************************************************************
+ * Validator.cc : Out of line parts of the model validators
+ **************************************************************************
+ * The pattern matching and error formatting used by the validators, which
+ * keeps <regex> and <format> out of Validator.hh, and the one copy of the
+ * validators for the common property types.
+ **************************************************************************
+ * License: 5G-MAG Public License (v1.0)
+ * Author: David Waring
+ * Copyright: (C)2025 British Broadcasting Corporation
+ *
+ * For full license terms please see the LICENSE file distributed with this
+ * program. If this file is missing then the license can be retrieved from
+ * https://drive.google.com/file/d/1cinCiA778IErENZ3JN52VFW-1ffHpx7Z/view
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <format>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <regex>
+#include <string>
+#include <string_view>
+
+#include "ModelException.hh"
+#include "ProblemCause.hh"
+
+#include "Validator.hh"
+
+namespace fiveg_mag_reftools {
+
+class CompiledPattern {
+public:
+    CompiledPattern(const std::string &regex) :m_regex(regex, std::regex_constants::ECMAScript) {};
+
+    bool matches(std::string_view str) const { return std::regex_match(str.begin(), str.end(), m_regex); };
+
+private:
+    std::regex m_regex;
+};
+
+std::shared_ptr<const CompiledPattern> compiledPattern(const char *pattern)
+{
+    static std::mutex pool_lock;
+    static std::map<std::string, std::shared_ptr<const CompiledPattern>, std::less<> > pool;
+
+    std::string_view pattern_str(pattern);
+    std::lock_guard<std::mutex> lock(pool_lock);
+    auto it = pool.find(pattern_str);
+    if (it == pool.end()) {
+        std::string regex(pattern_str.substr(1, pattern_str.size()-2));
+        it = pool.emplace(std::string(pattern_str), std::make_shared<const CompiledPattern>(regex)).first;
+    }
+    return it->second;
+}
+
+bool patternMatches(const CompiledPattern &pattern, std::string_view str)
+{
+    return pattern.matches(str);
+}
+
+void throwItemCountError(const char *classname, const char *fieldname, std::size_t limit, bool is_minimum, ProblemCause cause)
+{
+    if (is_minimum) {
+        throw ModelException(std::format("{}.{} must have at least {} entries", classname, fieldname, limit), classname, fieldname, cause);
+    }
+    throw ModelException(std::format("{}.{} can have at most {} entries", classname, fieldname, limit), classname, fieldname, cause);
+}
+
+} /* end namespace */
+
+template class fiveg_mag_reftools::StringValidator<std::string>;
+template class fiveg_mag_reftools::StringValidator<std::optional<std::string> >;
+template class fiveg_mag_reftools::NumberValidator<std::int32_t>;
+template class fiveg_mag_reftools::NumberValidator<std::optional<std::int32_t> >;
+template class fiveg_mag_reftools::NumberValidator<std::int64_t>;
+template class fiveg_mag_reftools::NumberValidator<std::optional<std::int64_t> >;
+template class fiveg_mag_reftools::NumberValidator<float>;
+template class fiveg_mag_reftools::NumberValidator<std::optional<float> >;
+template class fiveg_mag_reftools::NumberValidator<double>;
+template class fiveg_mag_reftools::NumberValidator<std::optional<double> >;
+template class fiveg_mag_reftools::NullValidator<bool>;
+template class fiveg_mag_reftools::NullValidator<std::optional<bool> >;
+OPENAPI_CONTAINER_VALIDATOR_TEMPLATES(, fiveg_mag_reftools::StringValidator<std::optional<std::string> >);
+OPENAPI_CONTAINER_VALIDATOR_TEMPLATES(, fiveg_mag_reftools::NumberValidator<std::optional<std::int32_t> >);
+
+/* vim:ts=8:sts=4:sw=4:expandtab:
+ */
@@ -22,14 +22,22 @@
 #include "core/ogs-memory.h"
 #undef OGS_CORE_INSIDE
 
-#include <format>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <map>
+#include <memory>
 #include <optional>
-#include <regex>
+#include <string>
+#include <string_view>
 #include <type_traits>
+#include <vector>
 
 #include "Boundary.hh"
 #include "CJson.hh"
 #include "ModelException.hh"
+#include "OgsAllocator.hh"
+#include "ParallelDecode.hh"
 #include "ProblemCause.hh"
 
 namespace fiveg_mag_reftools {
@@ -184,6 +192,20 @@ private:
     boundary_type *m_maximum;
 };
 
+/* Compiled form of a "/regex/" pattern. Patterns are compiled once and
+ * shared by every validator using them, so decoding many records of the
+ * same class does not recompile its patterns for each record. The regex
+ * itself is kept in Validator.cc so that <regex> is not parsed by every
+ * model. */
+class CompiledPattern;
+
+std::shared_ptr<const CompiledPattern> compiledPattern(const char *pattern);
+bool patternMatches(const CompiledPattern &pattern, std::string_view str);
+
+/* Throws the ModelException for a container with too few (is_minimum) or
+ * too many items */
+[[noreturn]] void throwItemCountError(const char *classname, const char *fieldname, std::size_t limit, bool is_minimum, ProblemCause cause);
+
 template <class T>
 class StringValidator : public Validator<T> {
 public:
@@ -192,76 +214,57 @@ public:
     StringValidator(const char *classname = nullptr, const char *fieldname = nullptr, const char *pattern = nullptr)
         :Validator<T>(classname, fieldname)
         ,m_pattern(pattern)
-        ,m_regex(nullptr)
+        ,m_regex()
     {
         if (m_pattern) {
-            std::string pattern(m_pattern);
-            pattern = pattern.substr(1,pattern.size()-2);
-            /* TODO: get regex from a pool */
-            m_regex = new std::regex(pattern, std::regex_constants::ECMAScript);
+            m_regex = compiledPattern(m_pattern);
         }
     }
 
+    /* The compiled regex is immutable so copies share it */
     StringValidator(const StringValidator &other)
         :Validator<T>(other)
         ,m_pattern(other.m_pattern)
-        ,m_regex(nullptr)
-    {
-        if (m_pattern) {
-            std::string pattern(m_pattern);
-            pattern = pattern.substr(1,pattern.size()-2);
-            /* TODO: use pool regex from "other" */
-            m_regex = new std::regex(pattern, std::regex_constants::ECMAScript);
-        }
-    };
+        ,m_regex(other.m_regex)
+    {};
 
     StringValidator(StringValidator &&other)
         :Validator<T>(std::move(other))
         ,m_pattern(other.m_pattern)
-        ,m_regex(other.m_regex)
-    {
-        other.m_regex = nullptr;
-    };
+        ,m_regex(std::move(other.m_regex))
+    {};
 
     StringValidator &operator=(const StringValidator &other)
     {
         this->Validator<T>::operator=(other);
         m_pattern = other.m_pattern;
-        if (m_regex) {
-            delete m_regex;
-            m_regex = nullptr;
-        }
-        if (m_pattern) {
-            std::string pattern(m_pattern);
-            pattern = pattern.substr(1,pattern.size()-2);
-            /* TODO: use pool regex from "other" */
-            m_regex = new std::regex(pattern, std::regex_constants::ECMAScript);
-        }
+        m_regex = other.m_regex;
         return *this;
     };
     StringValidator &operator=(StringValidator &&other)
     {
         this->Validator<T>::operator=(std::move(other));
         m_pattern = other.m_pattern;
-        if (m_regex) delete m_regex;
-        m_regex = other.m_regex;
-        other.m_regex = nullptr;
+        m_regex = std::move(other.m_regex);
         return *this;
     };
 
-    virtual ~StringValidator() {
-        if (m_regex) delete m_regex;
-    };
+    virtual ~StringValidator() {};
 
     virtual bool validate(const value_type &value) const {
         return _validate(value);
     };
 
+    /* Pattern check which does not throw, for choosing between alternatives */
+    bool matches(std::string_view str) const {
+        return !m_regex || patternMatches(*m_regex, str);
+    };
+
 private:
     template <typename U, typename std::enable_if<is_std_optional<U>::value, bool>::type = true>
     bool _validate(const U &value) const {
         if (value.has_value()) {
-            if (m_regex && !std::regex_match(value.value(), *m_regex)) {
+            if (!matches(std::string_view(value.value()))) {
                 throw ModelException("String did not match the correct format", this->m_classname, this->m_fieldname, ProblemCause::OPTIONAL_IE_INCORRECT);
             }
         }
@@ -271,7 +274,7 @@ private:
 
     template <typename U, typename std::enable_if<!is_std_optional<U>::value, bool>::type = true>
     bool _validate(const U &value) const {
-        if (m_regex && !std::regex_match(value, *m_regex)) {
+        if (!matches(std::string_view(value))) {
             throw ModelException("String did not match the correct format", this->m_classname, this->m_fieldname, ProblemCause::MANDATORY_IE_INCORRECT);
         }
 
@@ -279,7 +282,7 @@ private:
     };
 
     const char *m_pattern;
-    std::regex *m_regex;
+    std::shared_ptr<const CompiledPattern> m_regex;
 };
 
 template<class T>
@@ -331,7 +334,7 @@ public:
     {};
     
     virtual ~NullValidator() {};
-    virtual bool validate(const T &value) const { return true; };
+    virtual bool validate([[maybe_unused]] const T &value) const { return true; };
 };
 
 template <class C, class V>
@@ -350,25 +353,22 @@ public:
 
     ContainerValidator(const ContainerValidator &other)
         :Validator<container_type>(other)
-        ,m_itemValidator(new item_validator(*other.m_itemValidator))
+        ,m_itemValidator(other.m_itemValidator)
         ,m_minItems(other.m_minItems)
         ,m_maxItems(other.m_maxItems)
     {};
 
     ContainerValidator(ContainerValidator &&other)
         :Validator<container_type>(std::move(other))
-        ,m_itemValidator(other.m_itemValidator)
+        ,m_itemValidator(std::move(other.m_itemValidator))
         ,m_minItems(std::move(other.m_minItems))
         ,m_maxItems(std::move(other.m_maxItems))
-    {
-        other.m_itemValidator = nullptr;
-    };
+    {};
 
     ContainerValidator &operator=(const ContainerValidator &other)
     {
         this->Validator<container_type>::operator=(other);
-        if (m_itemValidator) delete m_itemValidator;
-        m_itemValidator = new item_validator(*other.m_itemValidator);
+        m_itemValidator = other.m_itemValidator;
         m_minItems = other.m_minItems;
         m_maxItems = other.m_maxItems;
         return *this;
@@ -377,17 +377,13 @@ public:
     ContainerValidator &operator=(ContainerValidator &&other)
     {
         this->Validator<container_type>::operator=(std::move(other));
-        if (m_itemValidator) delete m_itemValidator;
-        m_itemValidator = other.m_itemValidator;
-        other.m_itemValidator = nullptr;
+        m_itemValidator = std::move(other.m_itemValidator);
         m_minItems = std::move(other.m_minItems);
         m_maxItems = std::move(other.m_maxItems);
         return *this;
     };
 
-    virtual ~ContainerValidator() {
-        if (m_itemValidator) delete m_itemValidator;
-    };
+    virtual ~ContainerValidator() {};
 
     virtual bool validate(const container_type &value) const {
         return _validate(value);
@@ -400,17 +396,13 @@ private:
             if (m_minItems || m_maxItems) {
                 auto n_items = value.value().size();
                 if (m_minItems && m_minItems.value() > n_items) {
-                    throw ModelException(std::format("{}.{} must have at least {} entries", this->m_classname, this->m_fieldname, m_minItems.value()), this->m_classname, this->m_fieldname, ProblemCause::OPTIONAL_IE_INCORRECT);
+                    throwItemCountError(this->m_classname, this->m_fieldname, m_minItems.value(), true, ProblemCause::OPTIONAL_IE_INCORRECT);
                 }
                 if (m_maxItems && m_maxItems.value() < n_items) {
-                    throw ModelException(std::format("{}.{} can have at most {} entries", this->m_classname, this->m_fieldname, m_maxItems.value()), this->m_classname, this->m_fieldname, ProblemCause::OPTIONAL_IE_INCORRECT);
-                }
-            }
-            if (m_itemValidator) {
-                for (auto &var : value.value()) {
-                    m_itemValidator->validate(var);
+                    throwItemCountError(this->m_classname, this->m_fieldname, m_maxItems.value(), false, ProblemCause::OPTIONAL_IE_INCORRECT);
                 }
             }
+            if (m_itemValidator) _validateItems(value.value());
         }
         return true;
     };
@@ -420,21 +412,31 @@ private:
         if (m_minItems || m_maxItems) {
             auto n_items = value.size();
             if (m_minItems && m_minItems.value() > n_items) {
-                throw ModelException(std::format("{}.{} must have at least {} entries", this->m_classname, this->m_fieldname, m_minItems.value()), this->m_classname, this->m_fieldname, ProblemCause::MANDATORY_IE_INCORRECT);
+                throwItemCountError(this->m_classname, this->m_fieldname, m_minItems.value(), true, ProblemCause::MANDATORY_IE_INCORRECT);
             }
             if (m_maxItems && m_maxItems.value() < n_items) {
-                throw ModelException(std::format("{}.{} can have at most {} entries", this->m_classname, this->m_fieldname, m_maxItems.value()), this->m_classname, this->m_fieldname, ProblemCause::MANDATORY_IE_INCORRECT);
+                throwItemCountError(this->m_classname, this->m_fieldname, m_maxItems.value(), false, ProblemCause::MANDATORY_IE_INCORRECT);
             }
         }
-        if (m_itemValidator) {
-            for (auto &var : value) {
+        if (m_itemValidator) _validateItems(value);
+        return true;
+    };
+
+    template <typename L>
+    void _validateItems(const L &items) const {
+        if (ParallelDecode::enabled() && ParallelDecode::useFor(items.size())) {
+            std::vector<const typename L::value_type*> item_ptrs;
+            item_ptrs.reserve(items.size());
+            for (auto &var : items) item_ptrs.push_back(&var);
+            ParallelDecode::forEach(item_ptrs.size(), [&](std::size_t idx) { m_itemValidator->validate(*item_ptrs[idx]); });
+        } else {
+            for (auto &var : items) {
                 m_itemValidator->validate(var);
             }
         }
-        return true;
     };
 
-    item_validator *m_itemValidator;
+    std::shared_ptr<const item_validator> m_itemValidator;    /* immutable, shared by copies */
     std::optional<size_t> m_minItems;
     std::optional<size_t> m_maxItems;
 };
@@ -457,25 +459,22 @@ public:
 
     OptionalMapValidator(const OptionalMapValidator &other)
         :Validator<container_type>(other)
-        ,m_itemValidator(new item_validator(*other.m_itemValidator))
+        ,m_itemValidator(other.m_itemValidator)
         ,m_minItems(other.m_minItems)
         ,m_maxItems(other.m_maxItems)
     {};
 
     OptionalMapValidator(OptionalMapValidator &&other)
         :Validator<container_type>(std::move(other))
-        ,m_itemValidator(other.m_itemValidator)
+        ,m_itemValidator(std::move(other.m_itemValidator))
         ,m_minItems(std::move(other.m_minItems))
         ,m_maxItems(std::move(other.m_maxItems))
-    {
-        other.m_itemValidator = nullptr;
-    };
+    {};
 
     OptionalMapValidator &operator=(const OptionalMapValidator &other)
     {
         this->Validator<container_type>::operator=(other);
-        if (m_itemValidator) delete m_itemValidator;
-        m_itemValidator = new item_validator(*other.m_itemValidator);
+        m_itemValidator = other.m_itemValidator;
         m_minItems = other.m_minItems;
         m_maxItems = other.m_maxItems;
         return *this;
@@ -484,27 +483,23 @@ public:
     OptionalMapValidator &operator=(OptionalMapValidator &&other)
     {
         this->Validator<container_type>::operator=(std::move(other));
-        if (m_itemValidator) delete m_itemValidator;
-        m_itemValidator = other.m_itemValidator;
-        other.m_itemValidator = nullptr;
+        m_itemValidator = std::move(other.m_itemValidator);
         m_minItems = std::move(other.m_minItems);
         m_maxItems = std::move(other.m_maxItems);
         return *this;
     };
 
-    virtual ~OptionalMapValidator() {
-        if (m_itemValidator) delete m_itemValidator;
-    };
+    virtual ~OptionalMapValidator() {};
 
     virtual bool validate(const container_type &value) const {
         if (value.has_value()) {
             if (m_minItems || m_maxItems) {
                 auto n_items = value.value().size();
                 if (m_minItems && m_minItems.value() > n_items) {
-                    throw ModelException(std::format("{}.{} must have at least {} entries", this->m_classname, this->m_fieldname, m_minItems.value()), this->m_classname, this->m_fieldname, ProblemCause::OPTIONAL_IE_INCORRECT);
+                    throwItemCountError(this->m_classname, this->m_fieldname, m_minItems.value(), true, ProblemCause::OPTIONAL_IE_INCORRECT);
                 }
                 if (m_maxItems && m_maxItems.value() < n_items) {
-                    throw ModelException(std::format("{}.{} can have at most {} entries", this->m_classname, this->m_fieldname, m_maxItems.value()), this->m_classname, this->m_fieldname, ProblemCause::OPTIONAL_IE_INCORRECT);
+                    throwItemCountError(this->m_classname, this->m_fieldname, m_maxItems.value(), false, ProblemCause::OPTIONAL_IE_INCORRECT);
                 }
             }
             if (m_itemValidator) {
@@ -517,7 +512,7 @@ public:
     };
 
 private:
-    item_validator *m_itemValidator;
+    std::shared_ptr<const item_validator> m_itemValidator;
     std::optional<size_t> m_minItems;
     std::optional<size_t> m_maxItems;
 };
@@ -540,25 +535,22 @@ public:
 
     MapValidator(const MapValidator &other)
         :Validator<container_type>(other)
-        ,m_itemValidator(new item_validator(*other.m_itemValidator))
+        ,m_itemValidator(other.m_itemValidator)
         ,m_minItems(other.m_minItems)
         ,m_maxItems(other.m_maxItems)
     {};
 
     MapValidator(MapValidator &&other)
         :Validator<container_type>(std::move(other))
-        ,m_itemValidator(other.m_itemValidator)
+        ,m_itemValidator(std::move(other.m_itemValidator))
         ,m_minItems(std::move(other.m_minItems))
         ,m_maxItems(std::move(other.m_maxItems))
-    {
-        other.m_itemValidator = nullptr;
-    };
+    {};
 
     MapValidator &operator=(const MapValidator &other)
     {
         this->Validator<container_type>::operator=(other);
-        if (m_itemValidator) delete m_itemValidator;
-        m_itemValidator = new item_validator(*other.m_itemValidator);
+        m_itemValidator = other.m_itemValidator;
         m_minItems = other.m_minItems;
         m_maxItems = other.m_maxItems;
         return *this;
@@ -567,26 +559,22 @@ public:
     MapValidator &operator=(MapValidator &&other)
     {
         this->Validator<container_type>::operator=(std::move(other));
-        if (m_itemValidator) delete m_itemValidator;
-        m_itemValidator = other.m_itemValidator;
-        other.m_itemValidator = nullptr;
+        m_itemValidator = std::move(other.m_itemValidator);
         m_minItems = std::move(other.m_minItems);
         m_maxItems = std::move(other.m_maxItems);
         return *this;
     };
 
-    virtual ~MapValidator() {
-        if (m_itemValidator) delete m_itemValidator;
-    };
+    virtual ~MapValidator() {};
 
     virtual bool validate(const container_type &value) const {
         if (m_minItems || m_maxItems) {
             auto n_items = value.size();
             if (m_minItems && m_minItems.value() > n_items) {
-                throw ModelException(std::format("{}.{} must have at least {} entries", this->m_classname, this->m_fieldname, m_minItems.value()), this->m_classname, this->m_fieldname, ProblemCause::MANDATORY_IE_INCORRECT);
+                throwItemCountError(this->m_classname, this->m_fieldname, m_minItems.value(), true, ProblemCause::MANDATORY_IE_INCORRECT);
             }
             if (m_maxItems && m_maxItems.value() < n_items) {
-                throw ModelException(std::format("{}.{} can have at most {} entries", this->m_classname, this->m_fieldname, m_maxItems.value()), this->m_classname, this->m_fieldname, ProblemCause::MANDATORY_IE_INCORRECT);
+                throwItemCountError(this->m_classname, this->m_fieldname, m_maxItems.value(), false, ProblemCause::MANDATORY_IE_INCORRECT);
             }
         }
         if (m_itemValidator) {
@@ -598,7 +586,7 @@ public:
     };
 
 private:
-    item_validator *m_itemValidator;
+    std::shared_ptr<const item_validator> m_itemValidator;
     std::optional<size_t> m_minItems;
     std::optional<size_t> m_maxItems;
 };
@@ -611,6 +599,32 @@ using OptionalListValidator = ContainerValidator<std::optional<std::list<typenam
 
 } /* end namespace */
 
+/* Explicit instantiation declarations (extern_ is extern) or definitions
+ * (extern_ is empty) of the list and map validators for items validated by
+ * V. The generated models use these so that the validators for their
+ * types are compiled once, in the model's own translation unit. */
+#define OPENAPI_CONTAINER_VALIDATOR_TEMPLATES(extern_, V) \
+    extern_ template class fiveg_mag_reftools::ContainerValidator<std::list<V::value_type, fiveg_mag_reftools::OgsAllocator<V::value_type> >, V>; \
+    extern_ template class fiveg_mag_reftools::ContainerValidator<std::optional<std::list<V::value_type, fiveg_mag_reftools::OgsAllocator<V::value_type> > >, V>; \
+    extern_ template class fiveg_mag_reftools::MapValidator<V>; \
+    extern_ template class fiveg_mag_reftools::OptionalMapValidator<V>
+
+/* Validators for the common property types, instantiated in Validator.cc */
+extern template class fiveg_mag_reftools::StringValidator<std::string>;
+extern template class fiveg_mag_reftools::StringValidator<std::optional<std::string> >;
+extern template class fiveg_mag_reftools::NumberValidator<std::int32_t>;
+extern template class fiveg_mag_reftools::NumberValidator<std::optional<std::int32_t> >;
+extern template class fiveg_mag_reftools::NumberValidator<std::int64_t>;
+extern template class fiveg_mag_reftools::NumberValidator<std::optional<std::int64_t> >;
+extern template class fiveg_mag_reftools::NumberValidator<float>;
+extern template class fiveg_mag_reftools::NumberValidator<std::optional<float> >;
+extern template class fiveg_mag_reftools::NumberValidator<double>;
+extern template class fiveg_mag_reftools::NumberValidator<std::optional<double> >;
+extern template class fiveg_mag_reftools::NullValidator<bool>;
+extern template class fiveg_mag_reftools::NullValidator<std::optional<bool> >;
+OPENAPI_CONTAINER_VALIDATOR_TEMPLATES(extern, fiveg_mag_reftools::StringValidator<std::optional<std::string> >);
+OPENAPI_CONTAINER_VALIDATOR_TEMPLATES(extern, fiveg_mag_reftools::NumberValidator<std::optional<std::int32_t> >);
+
 /* vim:ts=8:sts=4:sw=4:expandtab:
  */
 
@@ -0,0 +1,305 @@
+/**************************************************************************
+ * base64_kernel_test.c : Tests for the base64 codec kernel
+ **************************************************************************
+ * Builds OpenAPI_base64_kernel.h with its CPU check replaced, so the
+ * scalar, SSSE3, AVX2 and AVX2 with SSSE3 paths are each forced in turn,
+ * and compares encoding, decoding and validation with a plain scalar
+ * reference. The buffers are allocated at their exact sizes, so building
+ * with -fsanitize=address also catches the vector loops reading or
+ * writing outside them.
+ **************************************************************************
+ * License: 5G-MAG Public License (v1.0)
+ * Author: David Waring
+ * Copyright: (C)2025 British Broadcasting Corporation
+ *
+ * For full license terms please see the LICENSE file distributed with this
+ * program. If this file is missing then the license can be retrieved from
+ * https://drive.google.com/file/d/1cinCiA778IErENZ3JN52VFW-1ffHpx7Z/view
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static bool test_cpu_supports(const char *isa);
+
+#define OPENAPI_BASE64_CPU_SUPPORTS(isa) test_cpu_supports(isa)
+#include "OpenAPI_base64_kernel.h"
+
+static int failures = 0;
+
+#define CHECK(cond) do { \
+        if (!(cond)) { \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+            failures++; \
+        } \
+    } while (0)
+
+#define ISA_SSSE3 0x1
+#define ISA_AVX2 0x2
+
+typedef struct {
+    const char *name;
+    unsigned int isas;
+} codec_path_t;
+
+static const codec_path_t paths[] = {
+    { "scalar", 0 },
+    { "ssse3", ISA_SSSE3 },
+    { "avx2", ISA_AVX2 },
+    { "avx2+ssse3", ISA_AVX2 | ISA_SSSE3 }
+};
+
+/* The extensions the kernel may use, and those it has asked for */
+static unsigned int forced_isas = 0;
+static unsigned int used_isas = 0;
+
+static bool test_cpu_supports(const char *isa)
+{
+    unsigned int flag = strcmp(isa, "avx2") == 0 ? ISA_AVX2 : ISA_SSSE3;
+
+    if (!(forced_isas & flag)) return false;
+    used_isas |= flag;
+    return true;
+}
+
+static bool cpu_has_path(const codec_path_t *path)
+{
+#ifdef OPENAPI_BASE64_X86
+    if ((path->isas & ISA_SSSE3) && !__builtin_cpu_supports("ssse3")) return false;
+    if ((path->isas & ISA_AVX2) && !__builtin_cpu_supports("avx2")) return false;
+    return true;
+#else
+    return path->isas == 0;
+#endif
+}
+
+/* xorshift64, so that runs are repeatable */
+static uint64_t rng_state = 2025;
+
+static uint64_t rng_next(void)
+{
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+    return rng_state;
+}
+
+static size_t rng_below(size_t limit)
+{
+    return (size_t)(rng_next() % limit);
+}
+
+/* Scalar reference, written from RFC 4648 rather than sharing any of the
+ * kernel's tables */
+static const char ref_alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+static int ref_value(unsigned char c)
+{
+    if (c >= 'A' && c <= 'Z') return c - 'A';
+    if (c >= 'a' && c <= 'z') return c - 'a' + 26;
+    if (c >= '0' && c <= '9') return c - '0' + 52;
+    if (c == '+') return 62;
+    if (c == '/') return 63;
+    return -1;
+}
+
+static size_t ref_encode(const unsigned char *data, size_t len, char *out)
+{
+    size_t n = 0;
+    size_t i;
+
+    for (i = 0; i < len; i += 3) {
+        uint32_t group = (uint32_t)data[i] << 16;
+        if (i + 1 < len) group |= (uint32_t)data[i + 1] << 8;
+        if (i + 2 < len) group |= data[i + 2];
+        out[n++] = ref_alphabet[(group >> 18) & 0x3f];
+        out[n++] = ref_alphabet[(group >> 12) & 0x3f];
+        out[n++] = (i + 1 < len) ? ref_alphabet[(group >> 6) & 0x3f] : '=';
+        out[n++] = (i + 2 < len) ? ref_alphabet[group & 0x3f] : '=';
+    }
+
+    return n;
+}
+
+/* Accepts the value with or without its padding, rejects anything else
+ * outside the alphabet. Unused low bits in the last character are ignored,
+ * as they are by the kernel. */
+static bool ref_decode(const char *str, size_t len, unsigned char *out, size_t *out_len)
+{
+    uint32_t bits = 0;
+    int num_bits = 0;
+    size_t n = 0;
+    size_t i;
+
+    if (len > 0 && len % 4 == 0 && str[len - 1] == '=') {
+        len--;
+        if (str[len - 1] == '=') len--;
+    }
+    if (len % 4 == 1) return false;
+
+    for (i = 0; i < len; i++) {
+        int value = ref_value((unsigned char)str[i]);
+        if (value < 0) return false;
+        bits = (bits << 6) | (uint32_t)value;
+        num_bits += 6;
+        if (num_bits >= 8) {
+            num_bits -= 8;
+            out[n++] = (unsigned char)(bits >> num_bits);
+            bits &= (1u << num_bits) - 1;
+        }
+    }
+
+    *out_len = n;
+    return true;
+}
+
+/* Decodes and validates str with the kernel and with the reference, in
+ * buffers of exactly the documented sizes */
+static void check_decode(const char *path, const char *str, size_t len)
+{
+    char *input = malloc(len ? len : 1);
+    unsigned char *out = malloc(OPENAPI_BASE64_DECODE_BUFFER_SIZE(len));
+    unsigned char *expected = malloc(len + 1);
+    size_t out_len = 0;
+    size_t expected_len = 0;
+    bool ok, expected_ok;
+
+    memcpy(input, str, len);
+    ok = _base64_decode(input, len, out, &out_len);
+    expected_ok = ref_decode(input, len, expected, &expected_len);
+
+    CHECK(ok == expected_ok);
+    CHECK(_base64_is_valid(input, len) == expected_ok);
+    if (ok && expected_ok) {
+        CHECK(out_len == expected_len);
+        CHECK(out_len == expected_len && memcmp(out, expected, out_len) == 0);
+    }
+    if (ok != expected_ok) {
+        fprintf(stderr, "  %s path: %zu character input %s by the kernel\n", path, len, ok?"accepted":"rejected");
+    }
+
+    free(expected);
+    free(out);
+    free(input);
+}
+
+/* Every length from 0 to 257, covering each vector width with every
+ * remainder, then random lengths */
+static void test_round_trip(const char *path)
+{
+    size_t iter;
+
+    for (iter = 0; iter < 258 + 200; iter++) {
+        size_t len = iter < 258 ? iter : 258 + rng_below(8192);
+        unsigned char *data = malloc(len ? len : 1);
+        char *encoded = malloc(len ? OPENAPI_BASE64_ENCODED_SIZE(len) : 1);
+        char *expected = malloc(OPENAPI_BASE64_ENCODED_SIZE(len) + 1);
+        size_t encoded_len, unpadded_len;
+        size_t i;
+
+        for (i = 0; i < len; i++) data[i] = (unsigned char)rng_next();
+
+        _base64_encode(data, len, encoded);
+        encoded_len = ref_encode(data, len, expected);
+        CHECK(encoded_len == OPENAPI_BASE64_ENCODED_SIZE(len));
+        CHECK(memcmp(encoded, expected, encoded_len) == 0);
+
+        check_decode(path, encoded, encoded_len);
+
+        /* without its padding */
+        unpadded_len = encoded_len;
+        while (unpadded_len > 0 && encoded[unpadded_len - 1] == '=') unpadded_len--;
+        check_decode(path, encoded, unpadded_len);
+
+        free(expected);
+        free(encoded);
+        free(data);
+    }
+}
+
+/* A character outside the alphabet, whitespace included, at each position
+ * of values long enough to reach every lane of the vector loops */
+static void test_invalid_characters(const char *path)
+{
+    static const char bad_chars[] = { ' ', '\n', '\r', '\t', '\0', '=', '-', '_', '.', '@', '[', '`', '{', '\x7f', '\x80', '\xff' };
+    size_t len;
+
+    for (len = 1; len <= 200; len += (len < 70 ? 1 : 13)) {
+        unsigned char *data = malloc(len);
+        char *encoded = malloc(OPENAPI_BASE64_ENCODED_SIZE(len));
+        size_t encoded_len = OPENAPI_BASE64_ENCODED_SIZE(len);
+        size_t pos, i;
+
+        for (i = 0; i < len; i++) data[i] = (unsigned char)rng_next();
+        ref_encode(data, len, encoded);
+
+        for (pos = 0; pos < encoded_len; pos++) {
+            char saved = encoded[pos];
+            encoded[pos] = bad_chars[(pos + len) % sizeof(bad_chars)];
+            check_decode(path, encoded, encoded_len);
+            encoded[pos] = saved;
+        }
+
+        free(encoded);
+        free(data);
+    }
+}
+
+/* Missing, misplaced and surplus padding, and whitespace around and inside
+ * the value, as arrive from hand written JSON */
+static void test_padding_and_whitespace(const char *path)
+{
+    static const char * const values[] = {
+        "", "=", "==", "===", "====", "A", "A=", "A==", "A===", "QQ", "QQ=", "QQ==", "QQ===", "QQ====",
+        "QUI", "QUI=", "QUI==", "QUJD", "QUJD=", "QUJD====", "Q=Q=", "QQ=A", "=QQQ", "QUJDRA", "QUJDRA=",
+        "QUJDRA==", "QUJDRA===", "QUJDREVGR0g", "QUJDREVGR0g=", "QUJDREVGR0g==",
+        " QUJD", "QUJD ", "QU JD", "QUJD\n", "\tQUJD", "QUJD\r\nRA==", "QUJD\nRA==\n",
+        "QUJDREVGR0hJSktMTU5PUFFSU1RVVldYWVphYmNkZWZnaGlqa2xtbm9wcXJzdHV2d3h5ejAxMjM0NTY3\r\nODk=",
+        "QUJDREVGR0hJSktMTU5PUFFSU1RVVldYWVphYmNkZWZnaGlqa2xtbm9wcXJzdHV2d3h5ejAxMjM0NTY3ODk=",
+        "QUJDREVGR0hJSktMTU5PUFFSU1RVVldYWVphYmNkZWZnaGlqa2xtbm9wcXJzdHV2d3h5ejAxMjM0NTY3ODk",
+        "QUJDREVGR0hJSktMTU5PUFFSU1RVVldYWVphYmNkZWZnaGlqa2xtbm9wcXJzdHV2d3h5ejAxMjM0NTY3ODk==",
+        "QUJDREVGR0hJSktMTU5PUFFSU1RVVldYWVphYmNkZWZnaGlqa2xtbm9wcXJzdHV2d3h5ejAx=jM0NTY3ODk",
+        "QUJDREVGR0hJSktMTU5PUFFSU1RVVldYWVphYmNkZWZnaGlqa2xtbm9wcXJzdHV2d3h5ejAxMjM0NTY3ODk=QUJD"
+    };
+    size_t i;
+
+    for (i = 0; i < sizeof(values) / sizeof(values[0]); i++) {
+        check_decode(path, values[i], strlen(values[i]));
+    }
+}
+
+int main(void)
+{
+    size_t i;
+
+    for (i = 0; i < sizeof(paths) / sizeof(paths[0]); i++) {
+        if (!cpu_has_path(&paths[i])) {
+            printf("base64_kernel_test: %s path skipped, not supported by this CPU\n", paths[i].name);
+            continue;
+        }
+
+        forced_isas = paths[i].isas;
+        used_isas = 0;
+        rng_state = 2025;
+
+        test_round_trip(paths[i].name);
+        test_invalid_characters(paths[i].name);
+        test_padding_and_whitespace(paths[i].name);
+
+        /* the kernel did try the forced extensions */
+        CHECK(used_isas == paths[i].isas);
+    }
+
+    if (failures) {
+        fprintf(stderr, "base64_kernel_test: %d checks failed\n", failures);
+        return 1;
+    }
+    printf("base64_kernel_test: passed\n");
+    return 0;
+}
+
+/* vim:ts=8:sts=4:sw=4:expandtab:
+ */
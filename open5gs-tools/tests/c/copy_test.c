@@ -0,0 +1,176 @@
+/**************************************************************************
+ * copy_test.c : Tests for the field-wise copy of C models
+ **************************************************************************
+ * Built with OPENAPI_COPY_SELF_CHECK, so every <Model>_copy() also asserts
+ * that the copy encodes the same as its source. Each copy is compared with
+ * the result of a print and parse round trip, which is what _copy() used
+ * to do.
+ **************************************************************************
+ * License: 5G-MAG Public License (v1.0)
+ * Author: David Waring
+ * Copyright: (C)2025 British Broadcasting Corporation
+ *
+ * For full license terms please see the LICENSE file distributed with this
+ * program. If this file is missing then the license can be retrieved from
+ * https://drive.google.com/file/d/1cinCiA778IErENZ3JN52VFW-1ffHpx7Z/view
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "ogs-core.h"
+
+#include "test_models_copy_test_item.h"
+#include "test_models_copy_test_shape.h"
+
+static int failures = 0;
+
+#define CHECK(cond) do { \
+        if (!(cond)) { \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+            failures++; \
+        } \
+    } while (0)
+
+static const char * const full_item =
+    "{\"id\":\"item1\",\"count\":3,\"ratio\":0.25,\"enabled\":false,"
+    "\"created\":\"2025-01-01T12:00:00Z\",\"secret\":\"hidden\",\"data\":\"aGVsbG8=\","
+    "\"instanceId\":\"4947a69a-f61b-4bc1-b9da-47c9c5d14b64\","
+    "\"tags\":[\"a\",\"b\"],\"scores\":[1.5,2,-3],"
+    "\"attrs\":{\"k1\":\"v1\",\"k2\":\"v2\"},\"weights\":{\"w\":0.5},"
+    "\"child\":{\"label\":\"c\",\"value\":1},"
+    "\"children\":[{\"label\":\"x\"},{\"label\":\"y\",\"value\":2}],"
+    "\"childMap\":{\"m\":{\"label\":\"z\"}},"
+    "\"extra\":{\"nested\":{\"list\":[1,\"two\",null]}},"
+    "\"shape\":{\"kind\":\"SQUARE\",\"side\":2,\"label\":\"sq\"},"
+    "\"colour\":\"GREEN\"}";
+
+static const char * const minimal_item = "{\"id\":\"item2\"}";
+
+static const char * const circle_item =
+    "{\"id\":\"item3\",\"shape\":{\"kind\":\"CIRCLE\",\"radius\":1.5},\"tags\":[]}";
+
+static bool json_equal(cJSON *a, cJSON *b)
+{
+    bool ret = cJSON_Compare(a, b, true);
+    if (!ret) {
+        char *sa = cJSON_PrintUnformatted(a);
+        char *sb = cJSON_PrintUnformatted(b);
+        fprintf(stderr, "  %s\n  %s\n", sa?sa:"(null)", sb?sb:"(null)");
+        cJSON_free(sa);
+        cJSON_free(sb);
+    }
+    return ret;
+}
+
+/* The copy must encode the same as a print and parse round trip */
+static void test_item_copy(const char *json_str, bool as_request)
+{
+    cJSON *json = cJSON_Parse(json_str);
+    const char *err = NULL;
+    /* parse as a response so that read-only fields are kept */
+    test_models_copy_test_item_t *src = test_models_copy_test_item_parseFromJSON(json, false, &err);
+    cJSON_Delete(json);
+    CHECK(src != NULL);
+    if (!src) return;
+
+    cJSON *printed = test_models_copy_test_item_convertToJSON(src, as_request);
+    CHECK(printed != NULL);
+    test_models_copy_test_item_t *round_trip = test_models_copy_test_item_parseFromJSON(printed, as_request, &err);
+    cJSON_Delete(printed);
+    CHECK(round_trip != NULL);
+
+    test_models_copy_test_item_t *copy = test_models_copy_test_item_copy(NULL, src, as_request);
+    CHECK(copy != NULL);
+
+    if (copy && round_trip) {
+        cJSON *expected = test_models_copy_test_item_convertToJSON(round_trip, as_request);
+        cJSON *actual = test_models_copy_test_item_convertToJSON(copy, as_request);
+        CHECK(json_equal(expected, actual));
+        cJSON_Delete(expected);
+        cJSON_Delete(actual);
+    }
+
+    /* copying into an existing object replaces it */
+    if (copy) {
+        test_models_copy_test_item_t *again = test_models_copy_test_item_copy(copy, src, as_request);
+        CHECK(again != NULL);
+        copy = again;
+    }
+
+    test_models_copy_test_item_free(copy);
+    test_models_copy_test_item_free(round_trip);
+    test_models_copy_test_item_free(src);
+}
+
+/* Polymorphic models copy the model selected by the discriminator */
+static void test_shape_copy(void)
+{
+    static const char * const shapes[] = {
+        "{\"kind\":\"CIRCLE\",\"radius\":0.5}",
+        "{\"kind\":\"SQUARE\",\"side\":4,\"label\":\"s\"}"
+    };
+    size_t i;
+
+    for (i = 0; i < sizeof(shapes)/sizeof(shapes[0]); i++) {
+        cJSON *json = cJSON_Parse(shapes[i]);
+        const char *err = NULL;
+        test_models_copy_test_shape_t *src = test_models_copy_test_shape_parseFromJSON(json, true, &err);
+        CHECK(src != NULL);
+        if (src) {
+            test_models_copy_test_shape_t *copy = test_models_copy_test_shape_copy(NULL, src, true);
+            CHECK(copy != NULL);
+            if (copy) {
+                cJSON *actual = test_models_copy_test_shape_convertToJSON(copy, true);
+                CHECK(json_equal(json, actual));
+                CHECK(*copy->kind_ptr == *src->kind_ptr);
+                cJSON_Delete(actual);
+            }
+            test_models_copy_test_shape_free(copy);
+            test_models_copy_test_shape_free(src);
+        }
+        cJSON_Delete(json);
+    }
+}
+
+/* A source missing a required field fails to copy, as it fails to print */
+static void test_missing_required(void)
+{
+    cJSON *json = cJSON_Parse(minimal_item);
+    const char *err = NULL;
+    test_models_copy_test_item_t *src = test_models_copy_test_item_parseFromJSON(json, true, &err);
+    cJSON_Delete(json);
+    CHECK(src != NULL);
+    if (!src) return;
+
+    ogs_free(src->id);
+    src->id = NULL;
+    CHECK(test_models_copy_test_item_copy(NULL, src, true) == NULL);
+
+    test_models_copy_test_item_free(src);
+}
+
+int main(void)
+{
+    ogs_core_initialize();
+
+    test_item_copy(full_item, true);
+    test_item_copy(full_item, false);
+    test_item_copy(minimal_item, true);
+    test_item_copy(circle_item, false);
+    test_shape_copy();
+    test_missing_required();
+
+    ogs_core_terminate();
+
+    if (failures) {
+        fprintf(stderr, "copy_test: %d checks failed\n", failures);
+        return 1;
+    }
+    printf("copy_test: passed\n");
+    return 0;
+}
+
+/* vim:ts=8:sts=4:sw=4:expandtab:
+ */
@@ -0,0 +1,226 @@
+/**************************************************************************
+ * move_test.c : Tests for the Move variants of parse and convert
+ **************************************************************************
+ * Checks that any_type _parseFromJSONMove() and _convertToJSONMove(), and
+ * the model functions built on them, give the same JSON as the copying
+ * functions and leave their sources holding NULLs. Each moved-from source
+ * is freed afterwards, so running under ASan also checks that nothing is
+ * leaked or freed twice.
+ **************************************************************************
+ * License: 5G-MAG Public License (v1.0)
+ * Author: David Waring
+ * Copyright: (C)2025 British Broadcasting Corporation
+ *
+ * For full license terms please see the LICENSE file distributed with this
+ * program. If this file is missing then the license can be retrieved from
+ * https://drive.google.com/file/d/1cinCiA778IErENZ3JN52VFW-1ffHpx7Z/view
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ogs-core.h"
+
+#include "any_type.h"
+#include "test_models_move_test_child.h"
+#include "test_models_move_test_item.h"
+
+static int failures = 0;
+
+#define CHECK(cond) do { \
+        if (!(cond)) { \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+            failures++; \
+        } \
+    } while (0)
+
+static const char * const full_item =
+    "{\"id\":\"item1\","
+    "\"value\":{\"nested\":{\"list\":[1,\"two\",null,true]},\"text\":\"big\"},"
+    "\"values\":[\"a\",2,{\"b\":[3]},[4,5],false],"
+    "\"valueMap\":{\"k1\":{\"x\":1},\"k2\":{\"y\":[2,{}]},\"k3\":{}},"
+    "\"child\":{\"label\":\"c\",\"value\":[{\"deep\":{\"deeper\":\"z\"}}]},"
+    "\"children\":[{\"label\":\"x\",\"value\":7.5},{\"label\":\"y\",\"value\":{\"k\":\"v\"}},{\"label\":\"z\"}]}";
+
+static const char * const minimal_item = "{\"id\":\"item2\"}";
+
+static bool json_equal(cJSON *a, cJSON *b)
+{
+    bool ret = cJSON_Compare(a, b, true);
+    if (!ret) {
+        char *sa = cJSON_PrintUnformatted(a);
+        char *sb = cJSON_PrintUnformatted(b);
+        fprintf(stderr, "  %s\n  %s\n", sa?sa:"(null)", sb?sb:"(null)");
+        cJSON_free(sa);
+        cJSON_free(sb);
+    }
+    return ret;
+}
+
+static bool json_null_or_missing(cJSON *json, const char *name)
+{
+    cJSON *member = cJSON_GetObjectItemCaseSensitive(json, name);
+    return !member || cJSON_IsNull(member);
+}
+
+/* Every any_type value in a parsed MoveTestItem tree is left as a JSON null */
+static bool source_moved_from(cJSON *json)
+{
+    bool ret = true;
+    cJSON *entry;
+
+    ret = ret && json_null_or_missing(json, "value");
+    cJSON_ArrayForEach(entry, cJSON_GetObjectItemCaseSensitive(json, "values")) {
+        ret = ret && cJSON_IsNull(entry);
+    }
+    cJSON_ArrayForEach(entry, cJSON_GetObjectItemCaseSensitive(json, "valueMap")) {
+        ret = ret && cJSON_IsNull(entry) && entry->string != NULL;
+    }
+    ret = ret && json_null_or_missing(cJSON_GetObjectItemCaseSensitive(json, "child"), "value");
+    cJSON_ArrayForEach(entry, cJSON_GetObjectItemCaseSensitive(json, "children")) {
+        ret = ret && json_null_or_missing(entry, "value");
+    }
+    return ret;
+}
+
+/* Every any_type value in a converted MoveTestItem is left NULL */
+static bool model_moved_from(const test_models_move_test_item_t *item)
+{
+    bool ret = item->value == NULL;
+    OpenAPI_lnode_t *node;
+
+    OpenAPI_list_for_each(item->values, node) {
+        ret = ret && node->data == NULL;
+    }
+    OpenAPI_list_for_each(item->value_map, node) {
+        OpenAPI_map_t *entry = node->data;
+        ret = ret && entry->key != NULL && entry->value == NULL;
+    }
+    if (item->child) ret = ret && item->child->value == NULL;
+    OpenAPI_list_for_each(item->children, node) {
+        test_models_move_test_child_t *child = node->data;
+        ret = ret && child->value == NULL;
+    }
+    return ret;
+}
+
+static test_models_move_test_item_t *parse_item(const char *json_str, bool move)
+{
+    cJSON *json = cJSON_Parse(json_str);
+    const char *err = NULL;
+    test_models_move_test_item_t *item = move ?
+        test_models_move_test_item_parseFromJSONMove(json, false, &err) :
+        test_models_move_test_item_parseFromJSON(json, false, &err);
+    cJSON_Delete(json);
+    return item;
+}
+
+/* The moved parse converts the same as the copied parse, and the source
+ * tree is still freed by its owner */
+static void test_parse_move(const char *json_str)
+{
+    cJSON *json = cJSON_Parse(json_str);
+    const char *err = NULL;
+    test_models_move_test_item_t *copied = parse_item(json_str, false);
+    test_models_move_test_item_t *moved = test_models_move_test_item_parseFromJSONMove(json, false, &err);
+    CHECK(copied != NULL);
+    CHECK(moved != NULL);
+    CHECK(source_moved_from(json));
+    cJSON_Delete(json);
+
+    if (copied && moved) {
+        cJSON *expected = test_models_move_test_item_convertToJSON(copied, false);
+        cJSON *actual = test_models_move_test_item_convertToJSON(moved, false);
+        CHECK(json_equal(expected, actual));
+        cJSON_Delete(expected);
+        cJSON_Delete(actual);
+    }
+
+    test_models_move_test_item_free(moved);
+    test_models_move_test_item_free(copied);
+}
+
+/* The moved convert gives the same JSON as the copied convert, and the
+ * moved-from model is still freed by its owner */
+static void test_convert_move(const char *json_str)
+{
+    test_models_move_test_item_t *item = parse_item(json_str, true);
+    CHECK(item != NULL);
+    if (!item) return;
+
+    cJSON *expected = test_models_move_test_item_convertToJSON(item, false);
+    cJSON *actual = test_models_move_test_item_convertToJSONMove(item, false);
+    CHECK(expected != NULL);
+    CHECK(actual != NULL);
+    CHECK(json_equal(expected, actual));
+    CHECK(model_moved_from(item));
+
+    test_models_move_test_item_free(item);
+
+    /* the moved tree is no longer shared with anything */
+    cJSON *round_trip = cJSON_Parse(json_str);
+    CHECK(json_equal(round_trip, actual));
+    cJSON_Delete(round_trip);
+    cJSON_Delete(actual);
+    cJSON_Delete(expected);
+}
+
+/* any_type on its own: the value moves out and the key stays behind */
+static void test_any_type(void)
+{
+    cJSON *json = cJSON_Parse("{\"key\":{\"a\":[1,2,3],\"b\":\"text\"},\"str\":\"value\",\"num\":42}");
+    cJSON *member;
+    const char *err = NULL;
+
+    cJSON_ArrayForEach(member, json) {
+        cJSON *expected = cJSON_Duplicate(member, 1);
+        test_models_any_type_t *copied = test_models_any_type_parseFromJSON(member, true, &err);
+        test_models_any_type_t *moved = test_models_any_type_parseFromJSONMove(member, true, &err);
+        CHECK(copied != NULL);
+        CHECK(moved != NULL);
+        CHECK(cJSON_IsNull(member));
+        CHECK(member->child == NULL && member->valuestring == NULL);
+        CHECK(member->string != NULL && strcmp(member->string, expected->string) == 0);
+
+        cJSON *copy_json = test_models_any_type_convertToJSON(copied, true);
+        cJSON *move_json = test_models_any_type_convertToJSONMove(moved, true);
+        CHECK(move_json == (cJSON*)moved);
+        CHECK(cJSON_Compare(copy_json, expected, true));
+        CHECK(cJSON_Compare(move_json, expected, true));
+
+        cJSON_Delete(move_json);
+        cJSON_Delete(copy_json);
+        test_models_any_type_free(copied);
+        cJSON_Delete(expected);
+    }
+
+    CHECK(cJSON_GetArraySize(json) == 3);
+    cJSON_Delete(json);
+
+    CHECK(test_models_any_type_parseFromJSONMove(NULL, true, &err) == NULL);
+}
+
+int main(void)
+{
+    ogs_core_initialize();
+
+    test_any_type();
+    test_parse_move(full_item);
+    test_parse_move(minimal_item);
+    test_convert_move(full_item);
+    test_convert_move(minimal_item);
+
+    ogs_core_terminate();
+
+    if (failures) {
+        fprintf(stderr, "move_test: %d checks failed\n", failures);
+        return 1;
+    }
+    printf("move_test: passed\n");
+    return 0;
+}
+
+/* vim:ts=8:sts=4:sw=4:expandtab:
+ */
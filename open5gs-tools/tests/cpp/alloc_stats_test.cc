@@ -0,0 +1,152 @@
+/**************************************************************************
+ * alloc_stats_test.cc : Tests for OgsAllocStats and OgsAllocTag
+ **************************************************************************
+ * License: 5G-MAG Public License (v1.0)
+ * Author: David Waring
+ * Copyright: (C)2025 British Broadcasting Corporation
+ *
+ * For full license terms please see the LICENSE file distributed with this
+ * program. If this file is missing then the license can be retrieved from
+ * https://drive.google.com/file/d/1cinCiA778IErENZ3JN52VFW-1ffHpx7Z/view
+ */
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <list>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "core/ogs-core.h"
+
+#include "OgsAllocator.hh"
+#include "OgsAllocStats.hh"
+
+using fiveg_mag_reftools::OgsAllocator;
+using fiveg_mag_reftools::OgsAllocStats;
+using fiveg_mag_reftools::OgsAllocTag;
+
+static std::atomic<int> failures(0);
+
+#define CHECK(cond) do { \
+        if (!(cond)) { \
+            std::fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+            failures++; \
+        } \
+    } while (0)
+
+static const char * const TestTag = "AllocStatsTest";
+
+/* A thread which has not allocated since accounting was enabled must be
+ * able to take a snapshot. Building the tag map of the snapshot allocates,
+ * which registers the thread while the snapshot is being taken, so this is
+ * run after tagged allocations have been made. */
+static void test_snapshot_on_new_thread()
+{
+    bool done = false;
+    std::thread thr([&done]() {
+        OgsAllocStats::Snapshot snap(OgsAllocStats::snapshot());
+        CHECK(snap.total().allocations > 0);
+        done = true;
+    });
+    thr.join();
+    CHECK(done);
+}
+
+static void test_tagged_allocations()
+{
+    OgsAllocStats::Snapshot before(OgsAllocStats::snapshot());
+    {
+        OgsAllocTag tag(TestTag);
+        std::list<std::uint64_t, OgsAllocator<std::uint64_t> > values;
+        for (std::uint64_t i = 0; i < 100; i++) values.push_back(i);
+    }
+    OgsAllocStats::Snapshot diff(OgsAllocStats::snapshot() - before);
+
+    auto it = diff.tags.find(TestTag);
+    CHECK(it != diff.tags.end());
+    if (it != diff.tags.end()) {
+        CHECK(it->second.allocations >= 100);
+        CHECK(it->second.bytes >= 100 * sizeof(std::uint64_t));
+    }
+    CHECK(diff.total().allocations >= 100);
+    CHECK(diff.total().frees >= 100);
+    CHECK(OgsAllocTag::current() == nullptr);
+}
+
+/* Counters of threads which have exited are kept in the retired totals */
+static void test_exited_threads()
+{
+    OgsAllocStats::Snapshot before(OgsAllocStats::snapshot());
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; i++) {
+        threads.emplace_back([]() {
+            OgsAllocTag tag(TestTag);
+            for (int j = 0; j < 50; j++) {
+                std::unique_ptr<std::string> str(new std::string(100, 'x'));
+            }
+        });
+    }
+    for (auto &thr : threads) thr.join();
+    OgsAllocStats::Snapshot diff(OgsAllocStats::snapshot() - before);
+
+    auto it = diff.tags.find(TestTag);
+    CHECK(it != diff.tags.end());
+    if (it != diff.tags.end()) CHECK(it->second.allocations >= 4 * 50);
+}
+
+/* Snapshots taken while other threads are allocating */
+static void test_concurrent_snapshots()
+{
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; i++) {
+        threads.emplace_back([]() {
+            for (int j = 0; j < 1000; j++) {
+                std::vector<int> values(j % 64 + 1);
+                if (j % 100 == 0) OgsAllocStats::snapshot();
+            }
+        });
+    }
+    for (int i = 0; i < 100; i++) OgsAllocStats::snapshot();
+    for (auto &thr : threads) thr.join();
+}
+
+static void test_json()
+{
+    {
+        OgsAllocTag tag(TestTag);
+        std::unique_ptr<std::string> str(new std::string(1000, 'x'));
+    }
+    fiveg_mag_reftools::CJson json(OgsAllocStats::snapshot().toJSON());
+    CHECK(json.isObject());
+    CHECK(json.getObjectItemCaseSensitive("total").isObject());
+    CHECK(json.getObjectItemCaseSensitive("tags").getObjectItemCaseSensitive(TestTag).isObject());
+    CHECK(json.getObjectItemCaseSensitive("sizeClasses").getObjectItemCaseSensitive("large").isObject());
+}
+
+int main()
+{
+    ogs_core_initialize();
+    OgsAllocStats::enable();
+
+    test_tagged_allocations();
+    test_snapshot_on_new_thread();
+    test_exited_threads();
+    test_concurrent_snapshots();
+    test_json();
+
+    OgsAllocStats::enable(false);
+    ogs_core_terminate();
+
+    if (failures) {
+        std::fprintf(stderr, "alloc_stats_test: %d checks failed\n", failures.load());
+        return 1;
+    }
+    std::printf("alloc_stats_test: passed\n");
+    return 0;
+}
+
+/* vim:ts=8:sts=4:sw=4:expandtab:
+ */
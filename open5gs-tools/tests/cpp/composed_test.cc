@@ -0,0 +1,251 @@
+/**************************************************************************
+ * composed_test.cc : Tests for composed (oneOf/anyOf) models
+ **************************************************************************
+ * Decodes the Composed* models of TestModels.yaml, which choose between
+ * their alternatives using Composed.hh. ComposedCat and ComposedDog have
+ * different members, so the alternative chosen for a value shows in what
+ * is left when it is encoded again.
+ **************************************************************************
+ * License: 5G-MAG Public License (v1.0)
+ * Author: David Waring
+ * Copyright: (C)2025 British Broadcasting Corporation
+ *
+ * For full license terms please see the LICENSE file distributed with this
+ * program. If this file is missing then the license can be retrieved from
+ * https://drive.google.com/file/d/1cinCiA778IErENZ3JN52VFW-1ffHpx7Z/view
+ */
+
+#include <cstdio>
+#include <memory>
+#include <string>
+
+#include "core/ogs-core.h"
+
+#include "CJson.hh"
+#include "ModelException.hh"
+#include "ComposedAnyPet.h"
+#include "ComposedCat.h"
+#include "ComposedCode.h"
+#include "ComposedDog.h"
+#include "ComposedLabel.h"
+#include "ComposedPet.h"
+#include "ComposedPetByType.h"
+#include "ComposedValue.h"
+
+using fiveg_mag_reftools::CJson;
+using fiveg_mag_reftools::ModelException;
+using test_models::ComposedAnyPet;
+using test_models::ComposedCat;
+using test_models::ComposedCode;
+using test_models::ComposedDog;
+using test_models::ComposedLabel;
+using test_models::ComposedPet;
+using test_models::ComposedPetByType;
+using test_models::ComposedValue;
+
+static int failures = 0;
+
+#define CHECK(cond) do { \
+        if (!(cond)) { \
+            std::fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+            failures++; \
+        } \
+    } while (0)
+
+static bool sameJson(const CJson &actual, const std::string &expected)
+{
+    if (actual == CJson::parse(expected)) return true;
+    std::fprintf(stderr, "  got %s, expected %s\n", actual.serialise().c_str(), expected.c_str());
+    return false;
+}
+
+/* json decodes as T, and encodes again as expected. Values are decoded and
+ * encoded as responses, so the read-only licence of ComposedDog is kept. */
+template <class T>
+static bool decodesAs(const std::string &json, const std::string &expected)
+{
+    try {
+        T value(CJson::parse(json), false);
+        return sameJson(value.toJSON(false), expected);
+    } catch (ModelException &ex) {
+        std::fprintf(stderr, "  %s rejected: %s\n", json.c_str(), ex.what());
+    }
+    return false;
+}
+
+/* The message of the error decoding json as T, empty if it decoded */
+template <class T>
+static std::string decodeError(const std::string &json, std::string *parameter = nullptr)
+{
+    try {
+        T value(CJson::parse(json), false);
+    } catch (ModelException &ex) {
+        if (parameter) *parameter = ex.parameter;
+        return ex.what();
+    }
+    return std::string();
+}
+
+/* The discriminator decides, even where the members say otherwise */
+static void test_discriminator()
+{
+    CHECK(decodesAs<ComposedPetByType>(R"({"petType":"dog","name":"rex","barks":3})",
+                                       R"({"petType":"dog","name":"rex","barks":3})"));
+    CHECK(decodesAs<ComposedPetByType>(R"({"petType":"cat","name":"tom","barks":3})",
+                                       R"({"petType":"cat","name":"tom"})"));
+    CHECK(decodesAs<ComposedPet>(R"({"petType":"cat","name":"tom","barks":3})",
+                                 R"({"petType":"cat","name":"tom","barks":3})"));
+
+    /* without the discriminator member the signature decides */
+    CHECK(decodesAs<ComposedPetByType>(R"({"name":"rex","barks":3})", R"({"name":"rex","barks":3})"));
+
+    std::string parameter;
+    CHECK(!decodeError<ComposedPetByType>(R"({"petType":"cow","name":"daisy"})", &parameter).empty());
+    CHECK(parameter == "petType");
+
+    /* the chosen alternative must still decode */
+    CHECK(!decodeError<ComposedPetByType>(R"({"petType":"dog","name":"rex"})").empty());
+}
+
+/* Without a discriminator the alternative is chosen by the value's
+ * signature: required members for objects, patterns for strings and the
+ * JSON type for everything else */
+static void test_signature()
+{
+    CHECK(decodesAs<ComposedPet>(R"({"name":"tom","meows":true})", R"({"name":"tom","meows":true})"));
+    CHECK(decodesAs<ComposedPet>(R"({"name":"tom"})", R"({"name":"tom"})"));
+    CHECK(decodeError<ComposedPet>(R"({"barks":1})") == "Value does not match any of the oneOf alternatives");
+    CHECK(!decodeError<ComposedPet>(R"("tom")").empty());
+    CHECK(!decodeError<ComposedPet>("[]").empty());
+
+    CHECK(decodesAs<ComposedValue>(R"("Any text, at ALL")", R"("Any text, at ALL")"));
+    CHECK(decodesAs<ComposedValue>("42", "42"));
+    CHECK(decodesAs<ComposedValue>(R"({"name":"tom","meows":false})", R"({"name":"tom","meows":false})"));
+    CHECK(decodesAs<ComposedValue>(R"(["a","b"])", R"(["a","b"])"));
+    CHECK(!decodeError<ComposedValue>("true").empty());
+    CHECK(!decodeError<ComposedValue>("null").empty());
+
+    CHECK(ComposedCat::jsonSignatureMatches(CJson::parse(R"({"name":"tom","other":1})")));
+    CHECK(ComposedCat::jsonUnknownMembers(CJson::parse(R"({"name":"tom","other":1,"more":2})")) == 2);
+    CHECK(!ComposedCat::jsonSignatureMatches(CJson::parse(R"({"meows":true})")));
+    CHECK(!ComposedCat::jsonSignatureMatches(CJson::parse(R"("tom")")));
+
+    /* a repeated member only stands for one required member */
+    CHECK(!ComposedDog::jsonSignatureMatches(CJson::parse(R"({"name":"a","name":"b"})")));
+    CHECK(ComposedDog::jsonSignatureMatches(CJson::parse(R"({"name":"a","name":"b","barks":1})")));
+
+    CHECK(ComposedPet::jsonSignatureMatches(CJson::parse(R"({"name":"rex","barks":1})")));
+    CHECK(!ComposedPet::jsonSignatureMatches(CJson::parse(R"({"barks":1})")));
+
+    /* exactly one oneOf pattern must match */
+    CHECK(decodesAs<ComposedCode>(R"("abc")", R"("abc")"));
+    CHECK(decodesAs<ComposedCode>(R"("123")", R"("123")"));
+    CHECK(!decodeError<ComposedCode>(R"("ab1")").empty());
+    CHECK(!decodeError<ComposedCode>(R"("")").empty());
+    CHECK(ComposedCode::jsonSignatureMatches(CJson::parse(R"("abc")")));
+    CHECK(!ComposedCode::jsonSignatureMatches(CJson::parse(R"("ABC")")));
+    CHECK(!ComposedCode::jsonSignatureMatches(CJson::parse("1")));
+}
+
+/* Unknown members do not stop an object alternative matching, but when
+ * more than one matches the one with the fewest unknown members wins */
+static void test_tie_break()
+{
+    /* ComposedCat does not know "barks" */
+    CHECK(decodesAs<ComposedPet>(R"({"name":"rex","barks":2})", R"({"name":"rex","barks":2})"));
+    /* ComposedDog lacks "barks", so only ComposedCat matches */
+    CHECK(decodesAs<ComposedPet>(R"({"name":"tom","meows":true,"colour":"grey"})", R"({"name":"tom","meows":true})"));
+    /* ComposedCat has two unknown members, ComposedDog one */
+    CHECK(decodesAs<ComposedPet>(R"({"name":"rex","barks":1,"meows":true,"licence":"L1"})",
+                                 R"({"name":"rex","barks":1,"licence":"L1"})"));
+    /* one unknown member each */
+    CHECK(decodeError<ComposedPet>(R"({"name":"rex","barks":1,"meows":true})") == "Value matches more than one of the oneOf alternatives");
+    CHECK(!decodeError<ComposedPet>(R"({"name":"rex","barks":1,"meows":true,"petType":"p"})").empty());
+    CHECK(!ComposedPet::jsonSignatureMatches(CJson::parse(R"({"name":"rex","barks":1,"meows":true})")));
+
+    /* an alternative without a pattern matches any string, so a string both
+     * alternatives match is rejected */
+    CHECK(decodesAs<ComposedLabel>(R"("Hello, World")", R"("Hello, World")"));
+    CHECK(decodesAs<ComposedLabel>(R"("")", R"("")"));
+    CHECK(!decodeError<ComposedLabel>(R"("123")").empty());
+    CHECK(ComposedLabel::jsonSignatureMatches(CJson::parse(R"("Hello")")));
+    CHECK(!ComposedLabel::jsonSignatureMatches(CJson::parse(R"("42")")));
+}
+
+template <class T>
+static bool patchesTo(const T &value, const std::string &patch, const std::string &expected)
+{
+    try {
+        std::unique_ptr<T> patched(value.newWithMergePatch(CJson::parse(patch)));
+        return sameJson(patched->toJSON(false), expected);
+    } catch (ModelException &ex) {
+        std::fprintf(stderr, "  patch %s rejected: %s\n", patch.c_str(), ex.what());
+    }
+    return false;
+}
+
+/* A merge patch can change the alternative which applies, an alternative
+ * which still applies keeps the members the request encoding leaves out */
+static void test_merge_patch()
+{
+    ComposedPet dog(CJson::parse(R"({"name":"rex","barks":3,"licence":"L1"})"), false);
+
+    CHECK(patchesTo(dog, R"({"barks":4})", R"({"name":"rex","barks":4,"licence":"L1"})"));
+    CHECK(sameJson(dog.toJSON(false), R"({"name":"rex","barks":3,"licence":"L1"})"));
+
+    /* no longer a ComposedDog, then a ComposedDog again */
+    CHECK(patchesTo(dog, R"({"barks":null,"meows":true})", R"({"name":"rex","meows":true})"));
+    std::unique_ptr<ComposedPet> cat(dog.newWithMergePatch(CJson::parse(R"({"barks":null,"meows":true})")));
+    CHECK(patchesTo(*cat, R"({"meows":null,"barks":7})", R"({"name":"rex","barks":7})"));
+
+    /* matching both alternatives equally is refused as it is when decoding */
+    bool thrown = false;
+    try {
+        std::unique_ptr<ComposedPet> both(dog.newWithMergePatch(CJson::parse(R"({"meows":true})")));
+    } catch (ModelException &ex) {
+        thrown = true;
+    }
+    CHECK(thrown);
+
+    /* read-only members cannot be patched */
+    thrown = false;
+    try {
+        std::unique_ptr<ComposedPet> licensed(dog.newWithMergePatch(CJson::parse(R"({"licence":"L2"})")));
+    } catch (ModelException &ex) {
+        thrown = true;
+    }
+    CHECK(thrown);
+
+    /* with a discriminator, patching it switches alternative */
+    ComposedPetByType by_type(CJson::parse(R"({"petType":"dog","name":"rex","barks":3,"licence":"L1"})"), false);
+    CHECK(patchesTo(by_type, R"({"barks":6})", R"({"petType":"dog","name":"rex","barks":6,"licence":"L1"})"));
+    CHECK(patchesTo(by_type, R"({"petType":"cat"})", R"({"petType":"cat","name":"rex"})"));
+
+    /* anyOf keeps every alternative which still matches */
+    ComposedAnyPet any(CJson::parse(R"({"name":"rex","barks":3,"licence":"L1"})"), false);
+    CHECK(sameJson(any.toJSON(false), R"({"name":"rex","barks":3,"licence":"L1"})"));
+    CHECK(patchesTo(any, R"({"barks":5})", R"({"name":"rex","barks":5,"licence":"L1"})"));
+    CHECK(patchesTo(any, R"({"barks":null,"meows":true})", R"({"name":"rex","meows":true})"));
+}
+
+int main()
+{
+    ogs_core_initialize();
+
+    test_discriminator();
+    test_signature();
+    test_tie_break();
+    test_merge_patch();
+
+    ogs_core_terminate();
+
+    if (failures) {
+        std::fprintf(stderr, "composed_test: %d checks failed\n", failures);
+        return 1;
+    }
+    std::printf("composed_test: passed\n");
+    return 0;
+}
+
+/* vim:ts=8:sts=4:sw=4:expandtab:
+ */
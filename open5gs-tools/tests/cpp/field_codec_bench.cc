@@ -0,0 +1,132 @@
+/**************************************************************************
+ * field_codec_bench.cc : Benchmark of the table driven field codec
+ **************************************************************************
+ * Compares decoding and encoding of the NF profile-like model generated
+ * with the per-field code (namespace test_models) and with the
+ * "tableDrivenCodec" option (namespace test_models_table), and reports
+ * the size of the .text sections of each set of model objects, which the
+ * Makefile measures with "size -A" when building the benchmark.
+ **************************************************************************
+ * License: 5G-MAG Public License (v1.0)
+ * Author: David Waring
+ * Copyright: (C)2025 British Broadcasting Corporation
+ *
+ * For full license terms please see the LICENSE file distributed with this
+ * program. If this file is missing then the license can be retrieved from
+ * https://drive.google.com/file/d/1cinCiA778IErENZ3JN52VFW-1ffHpx7Z/view
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+#include "core/ogs-core.h"
+
+#include "cpp-bindings/model/CJson.hh"
+#include "cpp-bindings/model/BenchProfile.h"
+#include "cpp-table-bindings/model/BenchProfile.h"
+
+/* Bytes of .text in the model objects of each variant, 0 if not measured */
+#ifndef INLINE_CODEC_TEXT_SIZE
+#define INLINE_CODEC_TEXT_SIZE 0
+#endif
+#ifndef TABLE_CODEC_TEXT_SIZE
+#define TABLE_CODEC_TEXT_SIZE 0
+#endif
+
+using fiveg_mag_reftools::CJson;
+
+static const char * const Profile = R"({
+    "nfInstanceId": "4947a69a-f61b-4bc1-b9da-47c9c5d14b64",
+    "nfStatus": "REGISTERED",
+    "heartBeatTimer": 10,
+    "fqdn": "af.example.com",
+    "ipv4Addresses": ["192.0.2.1", "192.0.2.2"],
+    "priority": 1,
+    "capacity": 100,
+    "load": 10,
+    "nfServices": {
+        "svc1": {"serviceInstanceId": "svc1", "serviceName": "maf-provisioning", "versions": ["v1"], "fqdn": "af.example.com", "load": 10},
+        "svc2": {"serviceInstanceId": "svc2", "serviceName": "maf-session-handling", "versions": ["v1"], "load": 5},
+        "svc3": {"serviceInstanceId": "svc3", "serviceName": "naf-eventexposure", "versions": ["v1", "v2"], "priority": 2}
+    }
+})";
+
+template <class F>
+static double nanosPerOp(long iterations, F &&op)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (long i = 0; i < iterations; i++) op();
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration<double, std::nano>(elapsed).count() / iterations;
+}
+
+struct CodecTimes {
+    double decode_ns;
+    double encode_ns;
+};
+
+template <class T>
+static CodecTimes timeCodec(long iterations, const CJson &json)
+{
+    T model(json, true);
+
+    CodecTimes times;
+    times.decode_ns = nanosPerOp(iterations, [&]() {
+        T decoded(json, true);
+    });
+    times.encode_ns = nanosPerOp(iterations, [&]() {
+        CJson encoded(model.toJSON(true));
+    });
+    return times;
+}
+
+static void printRow(const char *name, double inline_value, double table_value, const char *units, int precision = 1)
+{
+    std::printf("  %-8s %12.*f %12.*f %s %8.2fx\n", name, precision, inline_value, precision, table_value, units,
+                inline_value / table_value);
+}
+
+int main(int argc, char *argv[])
+{
+    long iterations = argc > 1 ? std::atol(argv[1]) : 100000;
+    if (iterations <= 0) {
+        std::fprintf(stderr, "Usage: %s [iterations]\n", argv[0]);
+        return 1;
+    }
+
+    ogs_core_initialize();
+
+    int ret = 0;
+    {
+        CJson json(CJson::parse(Profile));
+
+        /* Both variants must give the same result for the comparison to
+         * mean anything */
+        CJson inline_json(test_models::BenchProfile(json, true).toJSON(true));
+        CJson table_json(test_models_table::BenchProfile(json, true).toJSON(true));
+        if (!(inline_json == table_json)) {
+            std::fprintf(stderr, "field_codec_bench: results differ\n  per-field:    %s\n  table driven: %s\n",
+                         inline_json.serialise().c_str(), table_json.serialise().c_str());
+            ret = 1;
+        } else {
+            CodecTimes inline_times = timeCodec<test_models::BenchProfile>(iterations, json);
+            CodecTimes table_times = timeCodec<test_models_table::BenchProfile>(iterations, json);
+
+            std::printf("field_codec_bench: %ld iterations\n", iterations);
+            std::printf("  %-8s %12s %12s %5s %9s\n", "", "per-field", "table", "", "ratio");
+            printRow("decode", inline_times.decode_ns, table_times.decode_ns, "ns/op");
+            printRow("encode", inline_times.encode_ns, table_times.encode_ns, "ns/op");
+            if (INLINE_CODEC_TEXT_SIZE && TABLE_CODEC_TEXT_SIZE) {
+                printRow(".text", INLINE_CODEC_TEXT_SIZE, TABLE_CODEC_TEXT_SIZE, "bytes", 0);
+            }
+        }
+    }
+
+    ogs_core_terminate();
+
+    return ret;
+}
+
+/* vim:ts=8:sts=4:sw=4:expandtab:
+ */
@@ -0,0 +1,123 @@
+/**************************************************************************
+ * merge_patch_bench.cc : Benchmark of applying JSON Merge Patches
+ **************************************************************************
+ * Compares newWithMergePatch() with an RFC 7396 merge patch against
+ * newWithJSONPatches() with the equivalent list of RFC 6902 operations on
+ * an NF profile-like model.
+ **************************************************************************
+ * License: 5G-MAG Public License (v1.0)
+ * Author: David Waring
+ * Copyright: (C)2025 British Broadcasting Corporation
+ *
+ * For full license terms please see the LICENSE file distributed with this
+ * program. If this file is missing then the license can be retrieved from
+ * https://drive.google.com/file/d/1cinCiA778IErENZ3JN52VFW-1ffHpx7Z/view
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+
+#include "core/ogs-core.h"
+
+#include "CJson.hh"
+#include "BenchProfile.h"
+
+using fiveg_mag_reftools::CJson;
+using test_models::BenchProfile;
+
+static const char * const Profile = R"({
+    "nfInstanceId": "4947a69a-f61b-4bc1-b9da-47c9c5d14b64",
+    "nfStatus": "REGISTERED",
+    "heartBeatTimer": 10,
+    "fqdn": "af.example.com",
+    "ipv4Addresses": ["192.0.2.1", "192.0.2.2"],
+    "priority": 1,
+    "capacity": 100,
+    "load": 10,
+    "nfServices": {
+        "svc1": {"serviceInstanceId": "svc1", "serviceName": "maf-provisioning", "versions": ["v1"], "fqdn": "af.example.com", "load": 10},
+        "svc2": {"serviceInstanceId": "svc2", "serviceName": "maf-session-handling", "versions": ["v1"], "load": 5},
+        "svc3": {"serviceInstanceId": "svc3", "serviceName": "naf-eventexposure", "versions": ["v1", "v2"], "priority": 2}
+    }
+})";
+
+/* A typical NF profile update: status, load and heart beat changes, one
+ * service updated, one removed and one added */
+static const char * const MergePatch = R"({
+    "nfStatus": "SUSPENDED",
+    "heartBeatTimer": 20,
+    "load": 50,
+    "nfServices": {
+        "svc1": {"load": 60, "fqdn": null},
+        "svc2": null,
+        "svc4": {"serviceInstanceId": "svc4", "serviceName": "maf-data-reporting", "versions": ["v1"]}
+    }
+})";
+
+static const char * const JsonPatch = R"([
+    {"op": "replace", "path": "/nfStatus", "value": "SUSPENDED"},
+    {"op": "replace", "path": "/heartBeatTimer", "value": 20},
+    {"op": "replace", "path": "/load", "value": 50},
+    {"op": "replace", "path": "/nfServices/svc1/load", "value": 60},
+    {"op": "remove", "path": "/nfServices/svc1/fqdn"},
+    {"op": "remove", "path": "/nfServices/svc2"},
+    {"op": "add", "path": "/nfServices/svc4", "value": {"serviceInstanceId": "svc4", "serviceName": "maf-data-reporting", "versions": ["v1"]}}
+])";
+
+template <class F>
+static double nanosPerOp(long iterations, F &&op)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (long i = 0; i < iterations; i++) op();
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration<double, std::nano>(elapsed).count() / iterations;
+}
+
+int main(int argc, char *argv[])
+{
+    long iterations = argc > 1 ? std::atol(argv[1]) : 100000;
+    if (iterations <= 0) {
+        std::fprintf(stderr, "Usage: %s [iterations]\n", argv[0]);
+        return 1;
+    }
+
+    ogs_core_initialize();
+
+    int ret = 0;
+    {
+        BenchProfile profile(CJson::parse(Profile), true);
+        CJson merge_patch(CJson::parse(MergePatch));
+        CJson json_patch(CJson::parse(JsonPatch));
+
+        /* Both patches must produce the same result for the comparison to
+         * mean anything */
+        std::unique_ptr<BenchProfile> merged(profile.newWithMergePatch(merge_patch));
+        std::unique_ptr<BenchProfile> patched(profile.newWithJSONPatches(json_patch));
+        if (!(*merged == *patched)) {
+            std::fprintf(stderr, "merge_patch_bench: results differ\n  merge patch: %s\n  JSON patch:  %s\n",
+                         merged->toJSON(false).serialise().c_str(), patched->toJSON(false).serialise().c_str());
+            ret = 1;
+        } else {
+            double merge_ns = nanosPerOp(iterations, [&]() {
+                std::unique_ptr<BenchProfile> result(profile.newWithMergePatch(merge_patch));
+            });
+            double patch_ns = nanosPerOp(iterations, [&]() {
+                std::unique_ptr<BenchProfile> result(profile.newWithJSONPatches(json_patch));
+            });
+
+            std::printf("merge_patch_bench: %ld iterations\n", iterations);
+            std::printf("  newWithMergePatch():  %10.1f ns/op\n", merge_ns);
+            std::printf("  newWithJSONPatches(): %10.1f ns/op\n", patch_ns);
+            std::printf("  speedup:              %10.2fx\n", patch_ns / merge_ns);
+        }
+    }
+
+    ogs_core_terminate();
+
+    return ret;
+}
+
+/* vim:ts=8:sts=4:sw=4:expandtab:
+ */
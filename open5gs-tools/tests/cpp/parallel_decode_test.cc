@@ -0,0 +1,245 @@
+/**************************************************************************
+ * parallel_decode_test.cc : Tests for ParallelDecode
+ **************************************************************************
+ * Decodes the DecodeList model of TestModels.yaml with and without
+ * parallel decoding enabled, and exercises ParallelDecode::forEach() and
+ * ThreadPoolDecodeExecutor directly.
+ **************************************************************************
+ * License: 5G-MAG Public License (v1.0)
+ * Author: David Waring
+ * Copyright: (C)2025 British Broadcasting Corporation
+ *
+ * For full license terms please see the LICENSE file distributed with this
+ * program. If this file is missing then the license can be retrieved from
+ * https://drive.google.com/file/d/1cinCiA778IErENZ3JN52VFW-1ffHpx7Z/view
+ */
+
+#include <atomic>
+#include <cstddef>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <set>
+#include <string>
+
+#include "core/ogs-core.h"
+
+#include "CJson.hh"
+#include "ModelException.hh"
+#include "ParallelDecode.hh"
+#include "DecodeList.h"
+#include "DecodeEntry.h"
+
+using fiveg_mag_reftools::CJson;
+using fiveg_mag_reftools::DecodeExecutor;
+using fiveg_mag_reftools::ModelException;
+using fiveg_mag_reftools::ParallelDecode;
+using fiveg_mag_reftools::ThreadPoolDecodeExecutor;
+using test_models::DecodeEntry;
+using test_models::DecodeList;
+
+static std::atomic<int> failures(0);
+
+#define CHECK(cond) do { \
+        if (!(cond)) { \
+            std::fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+            failures++; \
+        } \
+    } while (0)
+
+static const std::size_t Threshold = 256;
+
+/* Counts the jobs run, and notes a job being started from inside one of
+ * its own tasks, which a nested array decoded in parallel would do */
+class CountingExecutor : public DecodeExecutor {
+public:
+    CountingExecutor() :runs(0) ,nested(false) ,m_pool(4) {};
+
+    virtual void run(std::size_t count, const std::function<void(std::size_t)> &task) {
+        if (t_inTask) nested = true;
+        runs++;
+        m_pool.run(count, [&task](std::size_t i) {
+            bool was_in_task = t_inTask;
+            t_inTask = true;
+            task(i);
+            t_inTask = was_in_task;
+        });
+    };
+
+    std::atomic<std::size_t> runs;
+    std::atomic<bool> nested;
+
+private:
+    static thread_local bool t_inTask;
+
+    ThreadPoolDecodeExecutor m_pool;
+};
+
+thread_local bool CountingExecutor::t_inTask = false;
+
+/* {"name":"entry<idx>","values":[idx+1, idx+2, ...]} with num_values values,
+ * or with a name which does not match the pattern if bad is set */
+static std::string makeEntry(std::size_t idx, std::size_t num_values, bool bad = false)
+{
+    std::string ret("{\"name\":\"");
+    ret += bad ? "BAD" : "entry" + std::to_string(idx);
+    ret += "\",\"values\":[";
+    for (std::size_t i = 0; i < num_values; i++) {
+        if (i) ret += ",";
+        ret += std::to_string(idx + i + 1);
+    }
+    return ret + "]}";
+}
+
+/* A DecodeList of num_entries entries and as many labels, the entries at
+ * the bad indices fail to decode */
+static std::string makeList(std::size_t num_entries, std::size_t num_values, const std::set<std::size_t> &bad = {})
+{
+    std::string ret("{\"entries\":[");
+    for (std::size_t i = 0; i < num_entries; i++) {
+        if (i) ret += ",";
+        ret += makeEntry(i, num_values, bad.count(i) > 0);
+    }
+    ret += "],\"labels\":[";
+    for (std::size_t i = 0; i < num_entries; i++) {
+        if (i) ret += ",";
+        ret += "\"label" + std::to_string(i) + "\"";
+    }
+    return ret + "]}";
+}
+
+/* The parameter of the error decoding json, empty if it decoded */
+static std::string decodeError(const std::string &json)
+{
+    try {
+        DecodeList list(CJson::parse(json), true);
+    } catch (ModelException &ex) {
+        return ex.parameter;
+    }
+    return std::string();
+}
+
+static void test_matches_serial()
+{
+    std::string json(makeList(20000, 8));
+    DecodeList serial(CJson::parse(json), true);
+
+    ParallelDecode::enable(std::make_shared<ThreadPoolDecodeExecutor>(4), Threshold);
+    for (int i = 0; i < 5; i++) {
+        DecodeList parallel(CJson::parse(json), true);
+        CHECK(parallel == serial);
+        CHECK(parallel.toJSON(false).serialise() == serial.toJSON(false).serialise());
+        CHECK(parallel.getEntries().size() == 20000);
+        CHECK(parallel.getLabels().has_value() && parallel.getLabels().value().size() == 20000);
+    }
+    ParallelDecode::disable();
+}
+
+/* Whichever chunk fails first, the error is the one for the lowest index */
+static void test_lowest_error()
+{
+    std::string json(makeList(20000, 2, {15000, 9000, 12000, 19999}));
+
+    CHECK(decodeError(json) == "entries[9000].name");
+
+    ParallelDecode::enable(std::make_shared<ThreadPoolDecodeExecutor>(4), Threshold);
+    for (int i = 0; i < 10; i++) {
+        CHECK(decodeError(json) == "entries[9000].name");
+    }
+
+    std::atomic<std::size_t> calls(0);
+    std::size_t thrown = 0;
+    try {
+        ParallelDecode::forEach(100000, [&calls](std::size_t idx) {
+            calls++;
+            if (idx == 70000 || idx == 30000 || idx == 99999) throw idx;
+        });
+    } catch (std::size_t idx) {
+        thrown = idx;
+    }
+    CHECK(thrown == 30000);
+    CHECK(calls.load() <= 100000);
+    ParallelDecode::disable();
+}
+
+/* The values arrays are over the threshold, but are decoded inside a task
+ * for the entries array, so must be decoded sequentially */
+static void test_nested_sequential()
+{
+    std::shared_ptr<CountingExecutor> executor(std::make_shared<CountingExecutor>());
+    ParallelDecode::enable(executor, Threshold);
+
+    /* on its own the values array is decoded and validated in parallel */
+    DecodeEntry entry(CJson::parse(makeEntry(0, Threshold * 2)), true);
+    CHECK(executor->runs.load() > 0);
+    CHECK(entry.getValues().has_value() && entry.getValues().value().size() == Threshold * 2);
+
+    executor->runs = 0;
+    DecodeList list(CJson::parse(makeList(Threshold * 4, Threshold * 2)), true);
+    CHECK(executor->runs.load() > 0);
+    CHECK(!executor->nested.load());
+    CHECK(list.getEntries().size() == Threshold * 4);
+
+    std::atomic<bool> parallel_in_task(false);
+    ParallelDecode::forEach(Threshold * 4, [&parallel_in_task](std::size_t) {
+        if (ParallelDecode::useFor(Threshold * 4)) parallel_in_task = true;
+    });
+    CHECK(!parallel_in_task.load());
+    CHECK(ParallelDecode::useFor(Threshold));
+
+    ParallelDecode::disable();
+    CHECK(!ParallelDecode::enabled());
+}
+
+/* Destroying a pool, used or not, joins its workers */
+static void test_pool_shutdown()
+{
+    for (std::size_t threads : {1, 2, 8}) {
+        ThreadPoolDecodeExecutor unused(threads);
+    }
+
+    for (int i = 0; i < 100; i++) {
+        std::atomic<std::size_t> sum(0);
+        {
+            ThreadPoolDecodeExecutor pool(8);
+            pool.run(1000, [&sum](std::size_t idx) { sum += idx; });
+        }
+        CHECK(sum.load() == 1000 * 999 / 2);
+    }
+
+    /* disable() drops the only other reference, so the pool goes with ours */
+    std::weak_ptr<DecodeExecutor> weak;
+    {
+        std::shared_ptr<DecodeExecutor> pool(std::make_shared<ThreadPoolDecodeExecutor>(4));
+        weak = pool;
+        ParallelDecode::enable(pool, Threshold);
+        DecodeList list(CJson::parse(makeList(Threshold * 2, 1)), true);
+        ParallelDecode::disable();
+    }
+    CHECK(weak.expired());
+
+    /* with no executor, decoding carries on sequentially */
+    CHECK(decodeError(makeList(Threshold * 2, 1, {3})) == "entries[3].name");
+}
+
+int main()
+{
+    ogs_core_initialize();
+
+    test_matches_serial();
+    test_lowest_error();
+    test_nested_sequential();
+    test_pool_shutdown();
+
+    ogs_core_terminate();
+
+    if (failures) {
+        std::fprintf(stderr, "parallel_decode_test: %d checks failed\n", failures.load());
+        return 1;
+    }
+    std::printf("parallel_decode_test: passed\n");
+    return 0;
+}
+
+/* vim:ts=8:sts=4:sw=4:expandtab:
+ */
@@ -0,0 +1,130 @@
+/**************************************************************************
+ * perfect_hash_test.cc : Tests for PerfectHash
+ **************************************************************************
+ * The large key sets are built at compile time, as they are for generated
+ * enums and objects, so this test failing to compile is also a failure.
+ **************************************************************************
+ * License: 5G-MAG Public License (v1.0)
+ * Author: David Waring
+ * Copyright: (C)2025 British Broadcasting Corporation
+ *
+ * For full license terms please see the LICENSE file distributed with this
+ * program. If this file is missing then the license can be retrieved from
+ * https://drive.google.com/file/d/1cinCiA778IErENZ3JN52VFW-1ffHpx7Z/view
+ */
+
+#include <array>
+#include <cstddef>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+#include "PerfectHash.hh"
+
+using fiveg_mag_reftools::PerfectHash;
+
+static int failures = 0;
+
+#define CHECK(cond) do { \
+        if (!(cond)) { \
+            std::fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+            failures++; \
+        } \
+    } while (0)
+
+/* Keys of differing lengths, like property names: "k0", "k1", ... "k2047" */
+template <std::size_t N>
+struct KeyStore {
+    static constexpr std::size_t Width = 6;
+
+    constexpr KeyStore() :chars(), lengths() {
+        for (std::size_t i = 0; i < N; i++) {
+            char digits[Width] = {};
+            std::size_t len = 0;
+            std::size_t value = i;
+            do {
+                digits[len++] = static_cast<char>('0' + value % 10);
+                value /= 10;
+            } while (value);
+            chars[i * Width] = 'k';
+            for (std::size_t j = 0; j < len; j++) chars[i * Width + 1 + j] = digits[len - 1 - j];
+            lengths[i] = len + 1;
+        }
+    };
+
+    constexpr std::array<std::string_view, N> keys() const {
+        std::array<std::string_view, N> ret{};
+        for (std::size_t i = 0; i < N; i++) ret[i] = std::string_view(chars.data() + i * Width, lengths[i]);
+        return ret;
+    };
+
+    std::array<char, N * Width> chars;
+    std::array<std::size_t, N> lengths;
+};
+
+static constexpr KeyStore<1000> s_keys_1000;
+static constexpr PerfectHash<1000> s_hash_1000(s_keys_1000.keys());
+static constexpr KeyStore<2048> s_keys_2048;
+static constexpr PerfectHash<2048> s_hash_2048(s_keys_2048.keys());
+
+static_assert(s_hash_1000.find("k0") == 1);
+static_assert(s_hash_1000.find("k999") == 1000);
+static_assert(s_hash_1000.find("k1000") == 0);
+static_assert(s_hash_2048.find("k2047") == 2048);
+
+static constexpr PerfectHash<0> s_hash_empty(std::array<std::string_view, 0>{});
+static_assert(s_hash_empty.find("") == 0);
+
+template <std::size_t N>
+static void test_all_keys(const PerfectHash<N> &hash, const KeyStore<N> &store)
+{
+    auto keys = store.keys();
+    for (std::size_t i = 0; i < N; i++) {
+        /* looked up from a runtime copy, not the stored string_view */
+        std::string key(keys[i]);
+        CHECK(hash.find(key) == i + 1);
+        CHECK(hash.key(i + 1) == keys[i]);
+    }
+    CHECK(hash.size() == N);
+}
+
+static void test_missing_keys()
+{
+    static const char * const missing[] = { "", "k", "k01", "k1000", "k9999", "K1", "k1 ", "x" };
+    for (auto key : missing) {
+        CHECK(s_hash_1000.find(key) == 0);
+    }
+}
+
+/* A repeated key is a compile error in generated code, at run time it is
+ * reported with an exception */
+static void test_duplicate_keys()
+{
+    bool thrown = false;
+    try {
+        PerfectHash<4> hash(std::to_array<std::string_view>({ "a", "b", "c", "b" }));
+        (void)hash;
+    } catch (std::logic_error &ex) {
+        thrown = true;
+    }
+    CHECK(thrown);
+}
+
+int main()
+{
+    test_all_keys(s_hash_1000, s_keys_1000);
+    test_all_keys(s_hash_2048, s_keys_2048);
+    test_missing_keys();
+    test_duplicate_keys();
+
+    if (failures) {
+        std::fprintf(stderr, "perfect_hash_test: %d checks failed\n", failures);
+        return 1;
+    }
+    std::printf("perfect_hash_test: passed\n");
+    return 0;
+}
+
+/* vim:ts=8:sts=4:sw=4:expandtab:
+ */
@@ -0,0 +1,260 @@
+/**************************************************************************
+ * push_parser_test.cc : Tests for CJson::PushParser
+ **************************************************************************
+ * Feeds documents to CJson::PushParser split at random chunk boundaries
+ * and checks the result against CJson::parse() of the whole document,
+ * including the inputs which cJSON_Parse() is lenient about.
+ **************************************************************************
+ * License: 5G-MAG Public License (v1.0)
+ * Author: David Waring
+ * Copyright: (C)2025 British Broadcasting Corporation
+ *
+ * For full license terms please see the LICENSE file distributed with this
+ * program. If this file is missing then the license can be retrieved from
+ * https://drive.google.com/file/d/1cinCiA778IErENZ3JN52VFW-1ffHpx7Z/view
+ */
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <iterator>
+#include <optional>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "core/ogs-core.h"
+
+#include "CJson.hh"
+#include "ModelException.hh"
+
+using namespace std::string_literals;
+
+using fiveg_mag_reftools::CJson;
+using fiveg_mag_reftools::ModelException;
+
+static int failures = 0;
+
+#define CHECK(cond) do { \
+        if (!(cond)) { \
+            std::fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+            failures++; \
+        } \
+    } while (0)
+
+/* Documents which parse() accepts or rejects, split below */
+static const std::string documents[] = {
+    /* plain JSON */
+    "{}", "[]", "\"\"", "0", "-0", "true", "false", "null",
+    R"({"name":"value","list":[1,2.5,-3e2,true,false,null,{}],"nested":{"a":{"b":[[],[{}]]}}})",
+    R"(  [ 1 , "two" , { "three" : 3 } ]  )",
+    R"(["esc\"aped\\\/\b\f\n\r\t", "\u00e9\u4e2d\ud83d\ude00", "\u0041BC"])",
+    R"({"number":12345678901234567890,"small":1e-300,"big":1.5E+300,"frac":0.000001})",
+    "123", "-1.25e-3", "1e5",
+    /* cJSON_Parse() leniency */
+    "\xEF\xBB\xBF{\"bom\":true}", "\xEF\xBB\xBF" "1", "\xEF\xBB\xBF [1]",
+    "{} trailing", "[1] [2]", "1 2", "true false", "\"a\"\"b\"", "nullx", "{}\0garbage"s, "1\0"s "2",
+    "01", "1.", "-01.e5", "[01, 1., 2.e1]", "00", "1e5.5", "1.5e", "1-2",
+    "\v\f[\v1\f]\x01", "[\"tab\there\", \"new\nline\"]",
+    "\"\\uZZZZ\"", "[\"a\\u00zzb\"]",
+    /* rejected */
+    "", " ", "\xEF\xBB\xBF", "\xEF\xBB{}", " \xEF\xBB\xBF{}", "\xEF{}",
+    "[1,]", "[,1]", "{\"a\"}", "{\"a\":}", "{\"a\" 1}", "{a:1}", "{'a':1}", "[1 2]", "{\"a\":1 \"b\":2}",
+    "[01x]", "[1.5e]", "[1-2]", "[1e5.5]", "[-]", "-", "+1", ".5", "[.5]", "[+1]",
+    "\"unterminated", "[\"\\x\"]", "[\"\\ud800\"]", "[\"\\udc00\"]", "[\"\\ud800\\u0041\"]", "\"\\u12\"",
+    "nul", "[tru]", "[nul]", "[falsy]", "{\0}"s, "[1\0]"s, "\"a\0\""s,
+    "]", "}", "[}", "{]", "[[]", "{\"a\":[}"
+};
+
+/* Parse json with a PushParser, split into chunks at cuts, returns false if
+ * it is rejected */
+static bool pushParse(const std::string &json, const std::vector<std::size_t> &cuts, std::optional<CJson> &result)
+{
+    CJson::PushParser parser;
+    try {
+        std::size_t start = 0;
+        for (std::size_t cut : cuts) {
+            parser.feed(json.data() + start, cut - start);
+            start = cut;
+        }
+        parser.feed(json.data() + start, json.size() - start);
+        result.emplace(parser.finish());
+    } catch (ModelException &ex) {
+        return false;
+    }
+    return true;
+}
+
+static std::string printable(const std::string &str)
+{
+    std::string ret;
+    for (unsigned char c : str) {
+        if (c < 0x20 || c >= 0x7f) {
+            char hex[8];
+            std::snprintf(hex, sizeof(hex), "\\x%02x", c);
+            ret += hex;
+        } else {
+            ret += static_cast<char>(c);
+        }
+    }
+    return ret;
+}
+
+/* Check json split at cuts gives the same result as parse() */
+static void checkSplit(const std::string &json, const std::vector<std::size_t> &cuts, const std::optional<CJson> &expected)
+{
+    std::optional<CJson> result;
+    bool accepted = pushParse(json, cuts, result);
+
+    /* CJson::operator== uses cJSON_Compare(), which ignores the order of
+     * object members, so the serialisations are compared as well */
+    bool same = accepted == expected.has_value();
+    if (same && accepted) {
+        same = *result == *expected && result->serialise() == expected->serialise();
+    }
+    CHECK(same);
+    if (!same) {
+        std::fprintf(stderr, "  document \"%s\" parse() %s, PushParser %s, cuts:", printable(json).c_str(),
+                     expected?"accepts":"rejects", accepted?"accepts":"rejects");
+        for (std::size_t cut : cuts) std::fprintf(stderr, " %zu", cut);
+        std::fprintf(stderr, "\n");
+    }
+}
+
+/* Whole, a byte at a time and split at random points */
+static void checkDocument(const std::string &json, std::mt19937 &rng)
+{
+    std::optional<CJson> expected;
+    try {
+        expected.emplace(CJson::parse(json));
+    } catch (ModelException &ex) {
+    }
+
+    checkSplit(json, {}, expected);
+
+    std::vector<std::size_t> cuts;
+    for (std::size_t i = 1; i < json.size(); i++) cuts.push_back(i);
+    checkSplit(json, cuts, expected);
+
+    for (int i = 0; i < 20 && json.size() > 1; i++) {
+        std::uniform_int_distribution<std::size_t> num_cuts(1, std::min<std::size_t>(json.size() - 1, 8));
+        std::uniform_int_distribution<std::size_t> position(0, json.size());
+        cuts.clear();
+        for (std::size_t n = num_cuts(rng); n > 0; n--) cuts.push_back(position(rng));
+        std::sort(cuts.begin(), cuts.end());
+        checkSplit(json, cuts, expected);
+    }
+}
+
+/* A random, valid document with random whitespace between tokens */
+static std::string randomValue(std::mt19937 &rng, int depth)
+{
+    static const char * const strings[] = { "", "text", "esc\\\"aped\\\\", "\\u00e9\\ud83d\\ude00", "tab\\tnew\\nline", "\\/" };
+    static const char * const numbers[] = { "0", "-0", "42", "-17", "3.25", "1e10", "-2.5E-7", "123456789012" };
+    static const char * const literals[] = { "true", "false", "null" };
+    static const char * const spaces[] = { "", " ", "\n", "\r\n  ", "\t" };
+    auto pick = [&rng](auto &array) {
+        return array[std::uniform_int_distribution<std::size_t>(0, std::size(array) - 1)(rng)];
+    };
+
+    std::string ret(pick(spaces));
+    int kind = std::uniform_int_distribution<int>(0, depth > 3 ? 3 : 5)(rng);
+    switch (kind) {
+    case 0:
+        ret += "\""s + pick(strings) + "\"";
+        break;
+    case 1:
+        ret += pick(numbers);
+        break;
+    case 2:
+        ret += pick(literals);
+        break;
+    case 3:
+        ret += "[]";
+        break;
+    case 4: {
+            ret += "[";
+            int count = std::uniform_int_distribution<int>(0, 5)(rng);
+            for (int i = 0; i < count; i++) {
+                if (i) ret += ",";
+                ret += randomValue(rng, depth + 1);
+            }
+            ret += "]";
+        }
+        break;
+    default: {
+            ret += "{";
+            int count = std::uniform_int_distribution<int>(0, 5)(rng);
+            for (int i = 0; i < count; i++) {
+                if (i) ret += ",";
+                ret += pick(spaces) + "\"key"s + std::to_string(i) + "\"" + pick(spaces) + ":" + randomValue(rng, depth + 1);
+            }
+            ret += "}";
+        }
+        break;
+    }
+    return ret + pick(spaces);
+}
+
+static void test_documents(std::mt19937 &rng)
+{
+    for (const auto &json : documents) checkDocument(json, rng);
+}
+
+static void test_random_documents(std::mt19937 &rng)
+{
+    for (int i = 0; i < 500; i++) checkDocument(randomValue(rng, 0), rng);
+}
+
+/* cJSON_Parse() allows 1000 levels of nesting */
+static void test_nesting(std::mt19937 &rng)
+{
+    checkDocument(std::string(1000, '[') + std::string(1000, ']'), rng);
+    checkDocument(std::string(1001, '[') + std::string(1001, ']'), rng);
+}
+
+/* finish() resets the parser for the next document */
+static void test_reuse()
+{
+    CJson::PushParser parser;
+    parser.feed("[1,");
+    CHECK(!parser.complete());
+    parser.feed("2] ignored");
+    CHECK(parser.complete());
+    CHECK(parser.finish().serialise() == "[1,2]");
+
+    parser.feed("\xEF\xBB\xBF{\"a\":");
+    parser.feed("1}");
+    CHECK(parser.finish().serialise() == "{\"a\":1}");
+
+    bool thrown = false;
+    try {
+        parser.finish();
+    } catch (ModelException &ex) {
+        thrown = true;
+    }
+    CHECK(thrown);
+}
+
+int main()
+{
+    ogs_core_initialize();
+
+    std::mt19937 rng(2025);
+    test_documents(rng);
+    test_random_documents(rng);
+    test_nesting(rng);
+    test_reuse();
+
+    ogs_core_terminate();
+
+    if (failures) {
+        std::fprintf(stderr, "push_parser_test: %d checks failed\n", failures);
+        return 1;
+    }
+    std::printf("push_parser_test: passed\n");
+    return 0;
+}
+
+/* vim:ts=8:sts=4:sw=4:expandtab:
+ */